@@ -0,0 +1,195 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "memory.h"
+#include "parser.h"
+#include "simulator.h"
+#include "workload.h"
+
+// Monotonic wall-clock time in nanoseconds
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --processes=N           Number of processes (default 1000)\n"
+          "  --arrival=DIST          Arrival gaps: poisson:MEAN or "
+          "bursty:SIZE:GAP\n"
+          "  --lifetime=DIST         Lifetimes: uniform:MIN:MAX or "
+          "exp:MEAN[:MIN]\n"
+          "  --pieces=DIST           Pieces per process\n"
+          "  --piece-size=DIST       Piece sizes in KB\n"
+          "  --memory=KB             Total memory (default 2000)\n"
+          "  --page=KB               Page size (default 100)\n"
+          "  --alloc=POLICY          paging, buddy, best-fit or next-fit\n"
+          "  --extents               Use the run-length page table\n"
+          "  --horizon=T             Last tick simulated (default %d)\n"
+          "  --seed=S                Random seed (default 1)\n"
+          "  --output=PATH           Where the event log goes (default "
+          "/dev/null)\n"
+          "  --keep-workload=PATH    Keep the generated input file\n",
+          program, SIM_END_TIME);
+}
+
+/**
+ * Runs the simulator on a synthetic workload and reports per-phase timings.
+ *
+ * Behavior:
+ *   1. Generates a workload and writes it in the input file format.
+ *   2. Times parsing it back with `parse_input_file` (plus page demand).
+ *   3. Times the simulation with the event log formatted into memory.
+ *   4. Times writing the formatted log to the output file.
+ *   5. Reports each phase along with events/sec and ns/event for the
+ * simulation phase, where an event is an arrival, admission or completion.
+ */
+int main(int argc, char *argv[]) {
+  WorkloadSpec spec;
+  default_workload_spec(&spec);
+  int total_memory = 2000;
+  int page_size = 100;
+  AllocPolicy policy = ALLOC_PAGING;
+  int extents = 0;
+  int horizon = SIM_END_TIME;
+  const char *output_path = "/dev/null";
+  const char *workload_path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+    int ok = 1;
+    if (strncmp(arg, "--processes=", 12) == 0) {
+      spec.num_processes = atoi(arg + 12);
+    } else if (strncmp(arg, "--arrival=", 10) == 0) {
+      ok = parse_distribution(arg + 10, &spec.arrival);
+    } else if (strncmp(arg, "--lifetime=", 11) == 0) {
+      ok = parse_distribution(arg + 11, &spec.lifetime);
+    } else if (strncmp(arg, "--pieces=", 9) == 0) {
+      ok = parse_distribution(arg + 9, &spec.pieces);
+    } else if (strncmp(arg, "--piece-size=", 13) == 0) {
+      ok = parse_distribution(arg + 13, &spec.piece_size);
+    } else if (strncmp(arg, "--memory=", 9) == 0) {
+      total_memory = atoi(arg + 9);
+    } else if (strncmp(arg, "--page=", 7) == 0) {
+      page_size = atoi(arg + 7);
+    } else if (strncmp(arg, "--alloc=", 8) == 0) {
+      ok = parse_alloc_policy(arg + 8, &policy);
+    } else if (strcmp(arg, "--extents") == 0) {
+      extents = 1;
+    } else if (strncmp(arg, "--horizon=", 10) == 0) {
+      horizon = atoi(arg + 10);
+    } else if (strncmp(arg, "--seed=", 7) == 0) {
+      spec.seed = strtoull(arg + 7, NULL, 10);
+    } else if (strncmp(arg, "--output=", 9) == 0) {
+      output_path = arg + 9;
+    } else if (strncmp(arg, "--keep-workload=", 16) == 0) {
+      workload_path = arg + 16;
+    } else {
+      ok = 0;
+    }
+    if (!ok) {
+      fprintf(stderr, "Error: Invalid option '%s'.\n", arg);
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (total_memory <= 0 || page_size <= 0 || total_memory % page_size != 0 ||
+      spec.num_processes <= 0) {
+    fprintf(stderr, "Error: Invalid memory size, page size or process count.\n");
+    return EXIT_FAILURE;
+  }
+
+  // Generate the workload and write it out in the input file format
+  char temp_path[] = "/tmp/memory_bench_XXXXXX";
+  if (!workload_path) {
+    int fd = mkstemp(temp_path);
+    if (fd == -1) {
+      perror("Error creating workload file");
+      return EXIT_FAILURE;
+    }
+    close(fd);
+    workload_path = temp_path;
+  }
+
+  int num_generated;
+  Process *generated = generate_workload(&spec, &num_generated);
+  FILE *workload_file = fopen(workload_path, "w");
+  if (!workload_file) {
+    perror("Error opening workload file");
+    return EXIT_FAILURE;
+  }
+  write_workload(workload_file, generated, num_generated);
+  fclose(workload_file);
+  free_parsed_data(generated, num_generated);
+
+  // Parse phase
+  double t0 = now_ns();
+  int num_processes;
+  Process *processes = parse_input_file(workload_path, &num_processes);
+  compute_page_demand(processes, num_processes, page_size);
+  double t1 = now_ns();
+  if (workload_path == temp_path) unlink(temp_path);
+
+  Memory memory;
+  init_memory_policy(&memory, total_memory, page_size, policy);
+  if (extents && !use_extent_table(&memory)) {
+    fprintf(stderr, "Error: --extents only supports --alloc=paging.\n");
+    return EXIT_FAILURE;
+  }
+
+  // Simulate phase, formatting the event log into memory
+  char *log = NULL;
+  size_t log_size = 0;
+  FILE *log_stream = open_memstream(&log, &log_size);
+  if (!log_stream) {
+    perror("Error opening log buffer");
+    return EXIT_FAILURE;
+  }
+
+  Simulator sim;
+  double t2 = now_ns();
+  sim_init(&sim, processes, num_processes, &memory, log_stream);
+  sim_run(&sim, horizon);
+  sim_print_summary(&sim);
+  fflush(log_stream);
+  double t3 = now_ns();
+
+  // Output phase
+  FILE *output = fopen(output_path, "w");
+  if (!output) {
+    perror("Error opening output file");
+    return EXIT_FAILURE;
+  }
+  fwrite(log, 1, log_size, output);
+  fclose(output);
+  double t4 = now_ns();
+
+  double simulate_ns = t3 - t2;
+  unsigned long events = sim.events;
+  printf("processes:        %d\n", num_processes);
+  printf("completed:        %d\n", sim.completed_processes);
+  printf("events:           %lu\n", events);
+  printf("output bytes:     %zu\n", log_size);
+  printf("parse:            %.3f ms\n", (t1 - t0) / 1e6);
+  printf("simulate:         %.3f ms\n", simulate_ns / 1e6);
+  printf("output:           %.3f ms\n", (t4 - t3) / 1e6);
+  if (events > 0) {
+    printf("events/sec:       %.0f\n", events / (simulate_ns / 1e9));
+    printf("ns/event:         %.1f\n", simulate_ns / events);
+  }
+
+  sim_free(&sim);
+  fclose(log_stream);
+  free(log);
+  free_parsed_data(processes, num_processes);
+  free_memory(&memory);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,273 @@
+#define _GNU_SOURCE
+#include "branch.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "buddy.h"
+#include "compact.h"
+#include "extent.h"
+#include "fit.h"
+#include "freetree.h"
+
+// Arrays start on 16-byte boundaries within the image
+#define BRANCH_ALIGN 16
+
+// Position in a branch image, either while the image is written (`base` is
+// NULL) or while a branch's arrays are pointed into its mapping
+typedef struct {
+  int fd;         // Image file being written
+  char *base;     // Branch's mapping of the image (NULL while writing)
+  size_t offset;  // Bytes of the image laid out so far
+} Layout;
+
+static void write_all(int fd, const void *data, size_t bytes) {
+  const char *at = data;
+  while (bytes > 0) {
+    ssize_t written = write(fd, at, bytes);
+    if (written < 0) {
+      perror("Error writing branch image");
+      exit(EXIT_FAILURE);
+    }
+    at += written;
+    bytes -= written;
+  }
+}
+
+// Appends an array to the image, or returns where the array lies in the
+// branch's mapping
+static void *share(Layout *layout, const void *data, size_t bytes) {
+  static const char padding[BRANCH_ALIGN];
+  size_t padded = (bytes + BRANCH_ALIGN - 1) / BRANCH_ALIGN * BRANCH_ALIGN;
+  void *at = NULL;
+  if (layout->base) {
+    at = layout->base + layout->offset;
+  } else {
+    write_all(layout->fd, data, bytes);
+    write_all(layout->fd, padding, padded - bytes);
+  }
+  layout->offset += padded;
+  return at;
+}
+
+// Lays out every large array of `parent` in the same order, pointing the
+// matching arrays of `child` at the result
+static void share_state(Layout *layout, const Simulator *parent,
+                        Simulator *child) {
+  const Memory *from = parent->memory;
+  Memory *to = child->memory;
+  size_t frames = from->total_pages;
+
+  // The process table comes first, so its ID column also marks the start of
+  // a mapping
+  const ProcessTable *processes = &parent->processes;
+  ProcessTable *table = &child->processes;
+  size_t count = processes->count;
+  table->id = share(layout, processes->id, count * sizeof(int));
+  table->arrival = share(layout, processes->arrival, count * sizeof(int));
+  table->lifetime = share(layout, processes->lifetime, count * sizeof(int));
+  table->start = share(layout, processes->start, count * sizeof(int));
+  table->pages_needed =
+      share(layout, processes->pages_needed, count * sizeof(int));
+  table->piece_offset =
+      share(layout, processes->piece_offset, (count + 1) * sizeof(int));
+  table->piece_pages =
+      share(layout, processes->piece_pages,
+            processes->piece_offset[count] * sizeof(int));
+  child->arrival_order =
+      share(layout, parent->arrival_order, count * sizeof(int));
+  if (from->page_table) {
+    to->page_table = share(layout, from->page_table, frames * sizeof(int));
+  }
+
+  const FreeTree *tree = from->free_tree;
+  size_t nodes = 2 * (size_t)tree->leaves;
+  to->free_tree->bits =
+      share(layout, tree->bits,
+            tree->leaves * FREE_TREE_WORDS * sizeof(uint64_t));
+  to->free_tree->free = share(layout, tree->free, nodes * sizeof(int));
+  to->free_tree->prefix = share(layout, tree->prefix, nodes * sizeof(int));
+  to->free_tree->suffix = share(layout, tree->suffix, nodes * sizeof(int));
+  to->free_tree->longest = share(layout, tree->longest, nodes * sizeof(int));
+  to->free_tree->runs = share(layout, tree->runs, nodes * sizeof(int));
+  to->free_tree->lazy = share(layout, tree->lazy, nodes);
+
+  if (from->buddy) {
+    const Buddy *buddy = from->buddy;
+    to->buddy->order = share(layout, buddy->order, frames * sizeof(int));
+    to->buddy->next = share(layout, buddy->next, frames * sizeof(int));
+    to->buddy->prev = share(layout, buddy->prev, frames * sizeof(int));
+    to->buddy->free_head = share(layout, buddy->free_head,
+                                 (buddy->max_order + 1) * sizeof(int));
+  }
+
+  if (from->fit) {
+    const Fit *fit = from->fit;
+    to->fit->len = share(layout, fit->len, frames * sizeof(int));
+    to->fit->end_start = share(layout, fit->end_start, frames * sizeof(int));
+    to->fit->priority =
+        share(layout, fit->priority, frames * sizeof(unsigned));
+    to->fit->size_left = share(layout, fit->size_left, frames * sizeof(int));
+    to->fit->size_right = share(layout, fit->size_right, frames * sizeof(int));
+    to->fit->addr_left = share(layout, fit->addr_left, frames * sizeof(int));
+    to->fit->addr_right = share(layout, fit->addr_right, frames * sizeof(int));
+    to->fit->addr_max = share(layout, fit->addr_max, frames * sizeof(int));
+  }
+}
+
+// Allocates a copy of a small structure
+static void *copy_struct(const void *from, size_t bytes) {
+  void *to = malloc(bytes);
+  if (!to) {
+    perror("Error allocating memory for branch");
+    exit(EXIT_FAILURE);
+  }
+  memcpy(to, from, bytes);
+  return to;
+}
+
+// Gives `child` its own copies of everything except the large arrays: the
+// counters, statistics, input queue, memory and allocator bookkeeping, and
+// the run-length extent table (which is small) or compact page table (which
+// can be widened, so it cannot live in a fixed-size mapping)
+static void copy_small_state(const Simulator *parent, Simulator *child,
+                             FILE *out) {
+  *child = *parent;
+  child->out = out;
+  child->trace = NULL;
+
+  init_queue(&child->queue);
+  for (QueueNode *node = parent->queue.front; node; node = node->next) {
+    enqueue(&child->queue, node->process);
+  }
+
+  const Memory *from = parent->memory;
+  Memory *to = copy_struct(from, sizeof(Memory));
+  to->free_tree = copy_struct(from->free_tree, sizeof(FreeTree));
+  if (from->buddy) to->buddy = copy_struct(from->buddy, sizeof(Buddy));
+  if (from->fit) to->fit = copy_struct(from->fit, sizeof(Fit));
+  if (from->extents) {
+    const ExtentTable *table = from->extents;
+    to->extents = copy_struct(table, sizeof(ExtentTable));
+    to->extents->capacity = table->count > 0 ? table->count : 1;
+    to->extents->runs =
+        copy_struct(table->runs, to->extents->capacity * sizeof(Extent));
+  }
+  if (from->compact) to->compact = compact_clone(from->compact);
+  child->memory = to;
+}
+
+// Frees what `copy_small_state` allocated
+static void free_small_state(Simulator *child) {
+  while (!is_queue_empty(&child->queue)) {
+    dequeue(&child->queue);
+  }
+  Memory *memory = child->memory;
+  extent_free(memory);
+  compact_destroy(memory->compact);
+  free(memory->fit);
+  free(memory->buddy);
+  free(memory->free_tree);
+  free(memory);
+  child->memory = NULL;
+}
+
+/**
+ * Freezes a simulation's large arrays so branches can share them.
+ *
+ * Args:
+ *   image (BranchImage*): Receives the image; release it with
+ * `branch_image_destroy` after closing every branch.
+ *   sim (const Simulator*): Simulation to branch from, between two ticks.
+ *
+ * Behavior:
+ *   - Copies the process table, arrival order, page table, free-frame tree
+ * and per-frame buddy or free-extent arrays once into an anonymous
+ * in-memory file.
+ *   - `sim` itself is unchanged and can carry on independently.
+ *   - Memory split into shards is not supported.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the file cannot be created
+ * or written.
+ */
+void branch_image_create(BranchImage *image, const Simulator *sim) {
+  image->fd = memfd_create("memory_simulator_branch", MFD_CLOEXEC);
+  if (image->fd < 0) {
+    perror("Error creating branch image");
+    exit(EXIT_FAILURE);
+  }
+
+  // Lay out the arrays through a throwaway set of small structures
+  Simulator scratch;
+  copy_small_state(sim, &scratch, NULL);
+  Layout layout = {image->fd, NULL, 0};
+  share_state(&layout, sim, &scratch);
+  free_small_state(&scratch);
+  image->bytes = layout.offset;
+}
+
+/**
+ * Starts a branch of a simulation from its image.
+ *
+ * Args:
+ *   image (BranchImage*): Image created from `parent`.
+ *   parent (const Simulator*): Simulation the image was created from, not
+ * advanced since.
+ *   child (Simulator*): Receives the branch; run it with `sim_step` or
+ * `sim_run` and release it with `branch_close`.
+ *   out (FILE*): Stream the branch's event log is written to.
+ *
+ * Behavior:
+ *   - Maps the image privately, so the branch reads the shared arrays and
+ * the kernel copies only the pages it writes. Opening many branches costs
+ * one mapping each, not a copy of the page table each.
+ *   - Copies the rest of the state (queue, counters, statistics, allocator
+ * roots, and extent runs or compact page table), which is small.
+ *   - The branch starts with `parent`'s admission policy and output level;
+ * switch policies with `sim_set_admission` to explore another one, and change
+ * `child->output` to skip formatting a log nobody reads.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the image cannot be mapped.
+ */
+void branch_open(BranchImage *image, const Simulator *parent, Simulator *child,
+                 FILE *out) {
+  char *base = mmap(NULL, image->bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                    image->fd, 0);
+  if (base == MAP_FAILED) {
+    perror("Error mapping branch image");
+    exit(EXIT_FAILURE);
+  }
+
+  copy_small_state(parent, child, out);
+  Layout layout = {image->fd, base, 0};
+  share_state(&layout, parent, child);
+}
+
+/**
+ * Releases a branch opened with `branch_open`.
+ *
+ * Args:
+ *   image (BranchImage*): Image the branch was opened from.
+ *   child (Simulator*): Branch to release.
+ */
+void branch_close(BranchImage *image, Simulator *child) {
+  munmap(child->processes.id, image->bytes);
+  memset(&child->processes, 0, sizeof(ProcessTable));
+  child->arrival_order = NULL;
+  free_small_state(child);
+}
+
+/**
+ * Releases a branch image.
+ *
+ * Args:
+ *   image (BranchImage*): Image from `branch_image_create`.
+ */
+void branch_image_destroy(BranchImage *image) {
+  close(image->fd);
+  image->fd = -1;
+}
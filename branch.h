@@ -0,0 +1,24 @@
+#ifndef BRANCH_H
+#define BRANCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "simulator.h"
+
+// Frozen copy of a simulation's large arrays (process table, arrival order,
+// page table and per-frame allocator state), which any number of branches
+// map copy-on-write
+typedef struct {
+  int fd;        // Anonymous in-memory file holding the arrays
+  size_t bytes;  // Size of the image
+} BranchImage;
+
+// Function prototypes
+void branch_image_create(BranchImage *image, const Simulator *sim);
+void branch_open(BranchImage *image, const Simulator *parent, Simulator *child,
+                 FILE *out);
+void branch_close(BranchImage *image, Simulator *child);
+void branch_image_destroy(BranchImage *image);
+
+#endif
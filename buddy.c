@@ -0,0 +1,323 @@
+#include "buddy.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "counters.h"
+#include "snapshot.h"
+
+// Removes a free block from the free list of its order
+static void unlink_block(Buddy *buddy, int block, int order) {
+  if (buddy->prev[block] != -1) {
+    buddy->next[buddy->prev[block]] = buddy->next[block];
+  } else {
+    buddy->free_head[order] = buddy->next[block];
+  }
+  if (buddy->next[block] != -1) {
+    buddy->prev[buddy->next[block]] = buddy->prev[block];
+  }
+}
+
+// Pushes a block onto the free list of the given order
+static void push_block(Buddy *buddy, int block, int order) {
+  buddy->order[block] = order;
+  buddy->prev[block] = -1;
+  buddy->next[block] = buddy->free_head[order];
+  if (buddy->free_head[order] != -1) {
+    buddy->prev[buddy->free_head[order]] = block;
+  }
+  buddy->free_head[order] = block;
+}
+
+// Smallest order whose block holds `pages` frames
+static int order_for_pages(int pages) {
+  int order = 0;
+  while ((1 << order) < pages) order++;
+  return order;
+}
+
+/**
+ * Sets up the buddy allocator over the memory's frames.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to an initialized `Memory` structure whose page
+ * table is entirely free.
+ *
+ * Behavior:
+ *   - Allocates the per-frame block arrays and the per-order free lists.
+ *   - Carves the frames into the largest naturally aligned power-of-two blocks
+ * that fit, so memories that are not a power of two pages are fully usable.
+ *     The buddy of every carved block lies beyond the end of memory, which
+ * keeps coalescing from ever crossing the carve boundaries.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+void buddy_init(Memory *memory) {
+  int total_pages = memory->total_pages;
+  Buddy *buddy = malloc(sizeof(Buddy));
+  if (!buddy) {
+    perror("Error allocating memory for buddy allocator");
+    exit(EXIT_FAILURE);
+  }
+
+  buddy->max_order = 0;
+  while ((2 << buddy->max_order) <= total_pages) buddy->max_order++;
+
+  buddy->order = malloc(total_pages * sizeof(int));
+  buddy->next = malloc(total_pages * sizeof(int));
+  buddy->prev = malloc(total_pages * sizeof(int));
+  buddy->free_head = malloc((buddy->max_order + 1) * sizeof(int));
+  if (!buddy->order || !buddy->next || !buddy->prev || !buddy->free_head) {
+    perror("Error allocating memory for buddy allocator");
+    exit(EXIT_FAILURE);
+  }
+
+  for (int i = 0; i < total_pages; i++) buddy->order[i] = -1;
+  for (int k = 0; k <= buddy->max_order; k++) buddy->free_head[k] = -1;
+
+  // Carve memory into aligned power-of-two blocks from the bottom up
+  int frame = 0;
+  while (frame < total_pages) {
+    int order = buddy->max_order;
+    while ((frame & ((1 << order) - 1)) != 0 ||
+           frame + (1 << order) > total_pages) {
+      order--;
+    }
+    push_block(buddy, frame, order);
+    frame += 1 << order;
+  }
+
+  memory->buddy = buddy;
+}
+
+// Takes a free block of exactly `order`, splitting a larger one if needed.
+// Returns the block's first frame, or -1 if no block is large enough.
+static int take_block(Buddy *buddy, int order) {
+  int k = order;
+  while (k <= buddy->max_order && buddy->free_head[k] == -1) {
+    COUNTER_ADD(alloc_pages_scanned, 1);  // An empty free list
+    k++;
+  }
+  if (k > buddy->max_order) return -1;
+  COUNTER_ADD(alloc_pages_scanned, 1);  // The block taken
+
+  int block = buddy->free_head[k];
+  unlink_block(buddy, block, k);
+
+  // Split down, returning the upper halves to the free lists
+  while (k > order) {
+    k--;
+    push_block(buddy, block + (1 << k), k);
+  }
+  buddy->order[block] = order;
+  return block;
+}
+
+// Returns an allocated block to the free lists, merging it with its buddy for
+// as long as the buddy is free and of the same order. Returns the first frame
+// of the resulting free block.
+static int release_block(Memory *memory, int block) {
+  Buddy *buddy = memory->buddy;
+  int order = buddy->order[block];
+
+  set_frame_owner(memory, block, 1 << order, -1);
+
+  while (order < buddy->max_order) {
+    int mate = block ^ (1 << order);
+    if (mate + (1 << order) > memory->total_pages ||
+        buddy->order[mate] != order || frame_owner(memory, mate) != -1) {
+      break;
+    }
+    unlink_block(buddy, mate, order);
+    buddy->order[mate > block ? mate : block] = -1;
+    if (mate < block) block = mate;
+    order++;
+  }
+  push_block(buddy, block, order);
+  return block;
+}
+
+/**
+ * Allocates contiguous buddy blocks for every memory piece of a process.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using the buddy
+ * allocator. process_id (int): The ID of the process requesting memory.
+ *   num_pieces (int): Number of memory segments required by the process.
+ *   piece_pages (const int*): Number of pages needed by each segment.
+ *
+ * Returns:
+ *   int: 1 if every piece was placed, 0 otherwise.
+ *
+ * Behavior:
+ *   - Rounds each piece up to a power-of-two block and takes the first free
+ * block of that order, splitting larger blocks as needed (O(log n) per piece).
+ *   - Marks every frame of each block with `process_id`, so internal
+ * fragmentation shows up in the memory map as extra pages of the process.
+ *   - If any piece cannot be placed, the blocks already taken for this call
+ * are released again and 0 is returned.
+ */
+int buddy_allocate(Memory *memory, int process_id, int num_pieces,
+                   const int *piece_pages) {
+  Buddy *buddy = memory->buddy;
+  int *blocks = malloc((num_pieces > 0 ? num_pieces : 1) * sizeof(int));
+  if (!blocks) {
+    perror("Error allocating memory for buddy blocks");
+    exit(EXIT_FAILURE);
+  }
+
+  for (int i = 0; i < num_pieces; i++) {
+    int order = order_for_pages(piece_pages[i] > 0 ? piece_pages[i] : 1);
+    int block = order <= buddy->max_order ? take_block(buddy, order) : -1;
+
+    if (block == -1) {
+      // Roll back the blocks taken so far
+      for (int j = i - 1; j >= 0; j--) release_block(memory, blocks[j]);
+      free(blocks);
+      return 0;
+    }
+
+    set_frame_owner(memory, block, 1 << order, process_id);
+    blocks[i] = block;
+  }
+
+  free(blocks);
+  return 1;
+}
+
+/**
+ * Releases every buddy block owned by a process.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using the buddy
+ * allocator. process_id (int): ID of the process whose blocks are freed.
+ *
+ * Returns:
+ *   int: Number of frames freed.
+ *
+ * Behavior:
+ *   - Walks memory block by block (not frame by frame) and releases the
+ * blocks owned by `process_id`, coalescing each with its free buddies.
+ */
+int buddy_deallocate(Memory *memory, int process_id) {
+  Buddy *buddy = memory->buddy;
+  int frames_freed = 0;
+
+  int frame = 0;
+  while (frame < memory->total_pages) {
+    COUNTER_ADD(dealloc_pages_scanned, 1);
+    if (frame_owner(memory, frame) == process_id) {
+      frames_freed += 1 << buddy->order[frame];
+      // The merged block may extend past this one; resume after all of it
+      frame = release_block(memory, frame);
+    }
+    frame += 1 << buddy->order[frame];
+  }
+  return frames_freed;
+}
+
+/**
+ * Writes the buddy allocator's block structure to a checkpoint.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using the buddy
+ * allocator.
+ *   file (FILE*): Checkpoint being written.
+ *
+ * Behavior:
+ *   - Writes the order of every block from the lowest frame up, then each
+ * free list from its head, so a restored allocator picks the same blocks.
+ */
+void buddy_save(Memory *memory, FILE *file) {
+  Buddy *buddy = memory->buddy;
+  int blocks = 0;
+  for (int frame = 0; frame < memory->total_pages;
+       frame += 1 << buddy->order[frame]) {
+    blocks++;
+  }
+  snapshot_write_int(file, blocks);
+  for (int frame = 0; frame < memory->total_pages;
+       frame += 1 << buddy->order[frame]) {
+    snapshot_write_int(file, buddy->order[frame]);
+  }
+
+  for (int k = 0; k <= buddy->max_order; k++) {
+    int count = 0;
+    for (int b = buddy->free_head[k]; b != -1; b = buddy->next[b]) count++;
+    snapshot_write_int(file, count);
+    for (int b = buddy->free_head[k]; b != -1; b = buddy->next[b]) {
+      snapshot_write_int(file, b);
+    }
+  }
+}
+
+/**
+ * Rebuilds the buddy allocator from a checkpoint.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using the buddy
+ * allocator, with the checkpoint's frame owners already restored.
+ *   file (FILE*): Checkpoint positioned after the frame owners.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the block structure does
+ * not fit this memory.
+ */
+void buddy_restore(Memory *memory, FILE *file) {
+  Buddy *buddy = memory->buddy;
+  for (int i = 0; i < memory->total_pages; i++) buddy->order[i] = -1;
+  for (int k = 0; k <= buddy->max_order; k++) buddy->free_head[k] = -1;
+
+  int blocks = snapshot_read_int(file);
+  int frame = 0;
+  for (int i = 0; i < blocks; i++) {
+    int order = snapshot_read_int(file);
+    if (order < 0 || order > buddy->max_order ||
+        frame + (1 << order) > memory->total_pages) {
+      snapshot_fail("buddy blocks do not fit memory");
+    }
+    buddy->order[frame] = order;
+    frame += 1 << order;
+  }
+  if (frame != memory->total_pages) {
+    snapshot_fail("buddy blocks do not cover memory");
+  }
+
+  for (int k = 0; k <= buddy->max_order; k++) {
+    int count = snapshot_read_int(file);
+    int *list = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!list) {
+      perror("Error allocating memory for buddy free list");
+      exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < count; i++) {
+      list[i] = snapshot_read_int(file);
+      if (list[i] < 0 || list[i] >= memory->total_pages ||
+          buddy->order[list[i]] != k || frame_owner(memory, list[i]) != -1) {
+        snapshot_fail("buddy free list names a block that is not free");
+      }
+    }
+    // Push from the tail so the list keeps its order
+    for (int i = count - 1; i >= 0; i--) push_block(buddy, list[i], k);
+    free(list);
+  }
+}
+
+/**
+ * Frees the buddy allocator's bookkeeping.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using the buddy
+ * allocator.
+ */
+void buddy_free(Memory *memory) {
+  Buddy *buddy = memory->buddy;
+  if (!buddy) return;
+  free(buddy->order);
+  free(buddy->next);
+  free(buddy->prev);
+  free(buddy->free_head);
+  free(buddy);
+  memory->buddy = NULL;
+}
@@ -0,0 +1,26 @@
+#ifndef BUDDY_H
+#define BUDDY_H
+
+#include "memory.h"
+
+// Bookkeeping for the buddy-system allocator. Blocks are identified by the
+// frame they start at; per-frame arrays are only meaningful at block heads.
+typedef struct Buddy {
+  int max_order;   // Largest block order (block of 2^max_order frames)
+  int *order;      // Order of the block starting at each frame (-1 if the
+                   // frame is not a block head)
+  int *next;       // Next free block of the same order (-1 for end of list)
+  int *prev;       // Previous free block of the same order (-1 for head)
+  int *free_head;  // First free block of each order (-1 if none)
+} Buddy;
+
+// Function prototypes
+void buddy_init(Memory *memory);
+int buddy_allocate(Memory *memory, int process_id, int num_pieces,
+                   const int *piece_pages);
+int buddy_deallocate(Memory *memory, int process_id);
+void buddy_save(Memory *memory, FILE *file);
+void buddy_restore(Memory *memory, FILE *file);
+void buddy_free(Memory *memory);
+
+#endif
@@ -0,0 +1,319 @@
+#include "cluster.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void *allocate_or_exit(size_t bytes) {
+  void *block = malloc(bytes > 0 ? bytes : 1);
+  if (!block) {
+    perror("Error allocating memory for cluster");
+    exit(EXIT_FAILURE);
+  }
+  return block;
+}
+
+// Runs one thread's share of the hosts to the end of the current window
+static void advance_hosts(Cluster *cluster, int first) {
+  for (int h = first; h < cluster->count; h += cluster->threads) {
+    sim_run(&cluster->hosts[h], cluster->window_end);
+  }
+}
+
+// Advances its share of the hosts once per window until told to stop
+static void *run_worker(void *arg) {
+  ClusterWorker *worker = arg;
+  Cluster *cluster = worker->cluster;
+  for (;;) {
+    pthread_barrier_wait(&cluster->start);
+    if (cluster->stopping) return NULL;
+    advance_hosts(cluster, worker->first);
+    pthread_barrier_wait(&cluster->done);
+  }
+}
+
+// Starts `threads` - 1 workers (threads <= 0 for one per online CPU), at
+// most one per host
+static void start_workers(Cluster *cluster, int threads) {
+  if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > cluster->count) threads = cluster->count;
+  if (threads < 1) threads = 1;
+#ifdef SIM_COUNTERS
+  // Counters are plain globals, so counting builds advance hosts one by one
+  threads = 1;
+#endif
+  cluster->threads = threads;
+  cluster->workers = NULL;
+  cluster->stopping = 0;
+  if (threads == 1) return;
+
+  pthread_barrier_init(&cluster->start, NULL, threads);
+  pthread_barrier_init(&cluster->done, NULL, threads);
+  cluster->workers = allocate_or_exit((threads - 1) * sizeof(ClusterWorker));
+  for (int t = 1; t < threads; t++) {
+    ClusterWorker *worker = &cluster->workers[t - 1];
+    worker->cluster = cluster;
+    worker->first = t;
+    if (pthread_create(&worker->thread, NULL, run_worker, worker) != 0) {
+      perror("Error starting cluster worker");
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+/**
+ * Initializes a cluster of idle hosts.
+ *
+ * Args:
+ *   cluster (Cluster*): Pointer to the cluster to initialize.
+ *   count (int): Number of hosts.
+ *   model (const Memory*): Freshly initialized memory each host's memory is
+ * shaped like (size, page size, placement strategy and extent or compact
+ * page table).
+ *   policy (RoutePolicy): How `cluster_run` routes processes to hosts.
+ *   threads (int): Threads advancing the hosts, or 0 for one per online
+ * CPU.
+ *
+ * Behavior:
+ *   - Gives each host its own memory and an empty simulation that admits
+ * FCFS and writes no event log; set `cluster->hosts[h].admission` to change
+ * the admission policy.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation or
+ * starting a thread fails.
+ */
+void cluster_init(Cluster *cluster, int count, const Memory *model,
+                  RoutePolicy policy, int threads) {
+  cluster->count = count;
+  cluster->hosts = allocate_or_exit(count * sizeof(Simulator));
+  cluster->memories = allocate_or_exit(count * sizeof(Memory));
+  cluster->routed = calloc(count, sizeof(int));
+  if (!cluster->routed) {
+    perror("Error allocating memory for cluster");
+    exit(EXIT_FAILURE);
+  }
+  for (int h = 0; h < count; h++) {
+    Memory *memory = &cluster->memories[h];
+    init_memory_policy(memory, model->total_memory, model->page_size,
+                       model->policy);
+    if (model->extents) use_extent_table(memory);
+    if (model->compact) use_compact_table(memory);
+    sim_init(&cluster->hosts[h], NULL, 0, memory, NULL);
+    cluster->hosts[h].output = OUTPUT_QUIET;
+  }
+  cluster->policy = policy;
+  cluster->next_host = 0;
+  start_workers(cluster, threads);
+}
+
+/**
+ * Looks up a routing policy by its command-line name.
+ *
+ * Args:
+ *   name (const char*): Policy name ("round-robin", "least-loaded" or
+ * "best-fit").
+ *   policy (RoutePolicy*): Receives the matching policy.
+ *
+ * Returns:
+ *   int: 1 if the name is known, 0 otherwise.
+ */
+int parse_route_policy(const char *name, RoutePolicy *policy) {
+  if (strcmp(name, "round-robin") == 0) {
+    *policy = ROUTE_ROUND_ROBIN;
+  } else if (strcmp(name, "least-loaded") == 0) {
+    *policy = ROUTE_LEAST_LOADED;
+  } else if (strcmp(name, "best-fit") == 0) {
+    *policy = ROUTE_BEST_FIT;
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+// Advances every host through tick `end`, on all threads at once
+static void advance(Cluster *cluster, int end) {
+  cluster->window_end = end;
+  if (cluster->workers) {
+    pthread_barrier_wait(&cluster->start);
+    advance_hosts(cluster, 0);
+    pthread_barrier_wait(&cluster->done);
+  } else {
+    advance_hosts(cluster, 0);
+  }
+}
+
+// Pages a host has committed: held by resident processes, needed by queued
+// ones, or routed to it and not arrived yet
+static int committed_pages(const Cluster *cluster, int h) {
+  const Simulator *host = &cluster->hosts[h];
+  const Memory *memory = host->memory;
+  int pages = memory->total_pages - memory_free_summary(memory).free_pages;
+  for (QueueNode *node = host->queue.front; node; node = node->next) {
+    pages += host->processes.pages_needed[node->process];
+  }
+  return pages + cluster->routed[h];
+}
+
+// Picks the host for a process needing `pages` pages
+static int pick_host(Cluster *cluster, int pages) {
+  if (cluster->policy == ROUTE_ROUND_ROBIN) {
+    int h = cluster->next_host;
+    cluster->next_host = (h + 1) % cluster->count;
+    return h;
+  }
+
+  int least = 0, least_pages = INT_MAX;
+  int best = -1, best_left = 0;
+  for (int h = 0; h < cluster->count; h++) {
+    int committed = committed_pages(cluster, h);
+    if (committed < least_pages) {
+      least = h;
+      least_pages = committed;
+    }
+    int left = cluster->memories[h].total_pages - committed - pages;
+    if (left >= 0 && (best == -1 || left < best_left)) {
+      best = h;
+      best_left = left;
+    }
+  }
+  return cluster->policy == ROUTE_BEST_FIT && best != -1 ? best : least;
+}
+
+/**
+ * Routes processes to the hosts as they arrive and simulates every host.
+ *
+ * Args:
+ *   cluster (Cluster*): Pointer to the cluster.
+ *   jobs (const ProcessTable*): Processes to route, with page demand for
+ * the hosts' page size.
+ *   end_time (int): Last clock tick to simulate.
+ *
+ * Behavior:
+ *   - Hosts never interact except through the dispatcher, and a host's
+ * state only matters to the dispatcher when processes arrive. Between two
+ * arrival times every host therefore runs its own event loop independently,
+ * on the cluster's threads; the hosts meet at each arrival time t, with
+ * every host through tick t - 1, and the dispatcher routes that tick's
+ * arrivals before the next window starts (conservative synchronization with
+ * the arrival times as lookahead).
+ *   - Round-robin routing does not look at the hosts, so every process is
+ * routed up front and the hosts run to `end_time` in a single window.
+ *   - Processes arriving at the same tick are routed in input order, each
+ * counting against its host as soon as it is routed.
+ */
+void cluster_run(Cluster *cluster, const ProcessTable *jobs, int end_time) {
+  int *order = process_table_arrival_order(jobs);
+  int next = 0;
+
+  // Processes with a negative arrival time never arrive
+  while (next < jobs->count && jobs->arrival[order[next]] < 0) next++;
+
+  while (next < jobs->count && jobs->arrival[order[next]] <= end_time) {
+    int time = jobs->arrival[order[next]];
+    if (cluster->policy != ROUTE_ROUND_ROBIN) {
+      advance(cluster, time - 1);
+      memset(cluster->routed, 0, cluster->count * sizeof(int));
+    }
+    while (next < jobs->count && jobs->arrival[order[next]] == time) {
+      int i = order[next++];
+      int h = pick_host(cluster, jobs->pages_needed[i]);
+      sim_add_process(&cluster->hosts[h], jobs, i);
+      cluster->routed[h] += jobs->pages_needed[i];
+    }
+  }
+
+  advance(cluster, end_time);
+  free(order);
+}
+
+/**
+ * Prints the average turnaround time over all hosts.
+ *
+ * Args:
+ *   cluster (Cluster*): Pointer to the cluster, run with `cluster_run`.
+ *   out (FILE*): Stream the summary is written to.
+ *   output (OutputLevel): Nothing is printed for OUTPUT_QUIET. From
+ * OUTPUT_EVENTS on, a line per host with its number of processes and
+ * average turnaround time comes first.
+ */
+void cluster_print_summary(Cluster *cluster, FILE *out, OutputLevel output) {
+  if (output < OUTPUT_SUMMARY) return;
+
+  double total_turnaround = 0;
+  int completed = 0;
+  for (int h = 0; h < cluster->count; h++) {
+    const Simulator *host = &cluster->hosts[h];
+    if (output >= OUTPUT_EVENTS) {
+      fprintf(out, "Host %d: %d processes, ", h, host->processes.count);
+      if (host->completed_processes > 0) {
+        fprintf(out, "Average Turnaround Time: %.2f\n",
+                host->total_turnaround / host->completed_processes);
+      } else {
+        fprintf(out, "Average Turnaround Time: N/A\n");
+      }
+    }
+    total_turnaround += host->total_turnaround;
+    completed += host->completed_processes;
+  }
+
+  if (completed > 0) {
+    fprintf(out, "\nAverage Turnaround Time: %.2f\n",
+            total_turnaround / completed);
+  } else {
+    fprintf(out, "No processes completed. Average Turnaround Time: N/A\n");
+  }
+}
+
+/**
+ * Prints the statistics of every host merged together.
+ *
+ * Args:
+ *   cluster (Cluster*): Pointer to the cluster, run with `cluster_run`.
+ *   out (FILE*): Stream the statistics are written to.
+ *   json (int): 1 for a JSON object, 0 for text.
+ *
+ * Notes:
+ *   - Distributions cover every process of every host; time-weighted means
+ * are per host, and utilization is over the memory of all hosts.
+ */
+void cluster_print_stats(Cluster *cluster, FILE *out, int json) {
+  SimStats merged;
+  stats_init(&merged, cluster->memories[0].total_pages);
+  stats_finish(&merged, 0);
+  for (int h = 0; h < cluster->count; h++) {
+    SimStats finished = cluster->hosts[h].stats;
+    stats_finish(&finished, cluster->hosts[h].clock);
+    stats_merge(&merged, &finished);
+  }
+  print_stats(out, &merged, json);
+}
+
+/**
+ * Stops the worker threads and frees every host.
+ *
+ * Args:
+ *   cluster (Cluster*): Pointer to the cluster.
+ */
+void cluster_free(Cluster *cluster) {
+  if (cluster->workers) {
+    cluster->stopping = 1;
+    pthread_barrier_wait(&cluster->start);
+    for (int t = 1; t < cluster->threads; t++) {
+      pthread_join(cluster->workers[t - 1].thread, NULL);
+    }
+    pthread_barrier_destroy(&cluster->start);
+    pthread_barrier_destroy(&cluster->done);
+    free(cluster->workers);
+    cluster->workers = NULL;
+  }
+  for (int h = 0; h < cluster->count; h++) {
+    sim_free(&cluster->hosts[h]);
+    free_memory(&cluster->memories[h]);
+  }
+  free(cluster->hosts);
+  free(cluster->memories);
+  free(cluster->routed);
+  cluster->count = 0;
+}
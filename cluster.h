@@ -0,0 +1,54 @@
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include "memory.h"
+#include "processtable.h"
+#include "simulator.h"
+
+// How the dispatcher picks a host for each arriving process
+typedef enum {
+  ROUTE_ROUND_ROBIN,   // Hosts in turn, regardless of their state
+  ROUTE_LEAST_LOADED,  // Host with the fewest pages held, queued or routed
+  ROUTE_BEST_FIT,      // Host left with the fewest uncommitted pages that
+                       // still holds the process (least loaded if none)
+} RoutePolicy;
+
+// Worker thread advancing every `threads`-th host of a cluster
+typedef struct ClusterWorker {
+  pthread_t thread;         // The thread
+  struct Cluster *cluster;  // Cluster it belongs to
+  int first;                // First host it advances
+} ClusterWorker;
+
+// Independent hosts, each one memory simulation with its own memory and
+// input queue, fed by a dispatcher that routes processes as they arrive
+typedef struct Cluster {
+  int count;           // Number of hosts
+  Simulator *hosts;    // Each host's simulation
+  Memory *memories;    // Each host's memory
+  RoutePolicy policy;  // How processes are routed
+  int next_host;       // Next host in turn for ROUTE_ROUND_ROBIN
+  int *routed;         // Pages routed to each host that have not arrived yet
+
+  // Hosts advance on `threads` threads at once (`workers` is NULL when one)
+  int threads;              // Threads advancing hosts, the caller included
+  ClusterWorker *workers;   // Threads 1 to threads - 1
+  pthread_barrier_t start;  // Releases the workers onto a window
+  pthread_barrier_t done;   // Waits for every host to finish the window
+  int window_end;           // Last tick of the current window
+  int stopping;             // Set to make the workers exit
+} Cluster;
+
+// Function prototypes
+void cluster_init(Cluster *cluster, int count, const Memory *model,
+                  RoutePolicy policy, int threads);
+int parse_route_policy(const char *name, RoutePolicy *policy);
+void cluster_run(Cluster *cluster, const ProcessTable *jobs, int end_time);
+void cluster_print_summary(Cluster *cluster, FILE *out, OutputLevel output);
+void cluster_print_stats(Cluster *cluster, FILE *out, int json);
+void cluster_free(Cluster *cluster);
+
+#endif
@@ -0,0 +1,324 @@
+#include "compact.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void *allocate_or_exit(size_t bytes) {
+  void *block = malloc(bytes > 0 ? bytes : 1);
+  if (!block) {
+    perror("Error allocating memory for compact page table");
+    exit(EXIT_FAILURE);
+  }
+  return block;
+}
+
+// Largest slot an entry of `width` bytes can hold
+static int slot_limit(int width) {
+  return width == 1 ? UINT8_MAX : width == 2 ? UINT16_MAX : INT_MAX;
+}
+
+static int get_entry(const CompactTable *table, int frame) {
+  switch (table->width) {
+    case 1:
+      return ((const uint8_t *)table->entries)[frame];
+    case 2:
+      return ((const uint16_t *)table->entries)[frame];
+    default:
+      return ((const uint32_t *)table->entries)[frame];
+  }
+}
+
+static void put_entry(CompactTable *table, int frame, int slot) {
+  switch (table->width) {
+    case 1:
+      ((uint8_t *)table->entries)[frame] = slot;
+      break;
+    case 2:
+      ((uint16_t *)table->entries)[frame] = slot;
+      break;
+    default:
+      ((uint32_t *)table->entries)[frame] = slot;
+  }
+}
+
+// Doubles the width of every entry
+static void widen(CompactTable *table) {
+  CompactTable wider = *table;
+  wider.width = table->width * 2;
+  wider.entries = allocate_or_exit((size_t)table->frames * wider.width);
+  for (int i = 0; i < table->frames; i++) {
+    put_entry(&wider, i, get_entry(table, i));
+  }
+  free(table->entries);
+  table->entries = wider.entries;
+  table->width = wider.width;
+}
+
+static unsigned bucket_of(const CompactTable *table, int id) {
+  return ((uint32_t)id * 2654435761u) & (table->map_capacity - 1);
+}
+
+// Slot held by a process (0 if it holds no frames)
+static int lookup_slot(const CompactTable *table, int id) {
+  unsigned mask = table->map_capacity - 1;
+  for (unsigned b = bucket_of(table, id); table->map_slot[b] != 0;
+       b = (b + 1) & mask) {
+    if (table->map_id[b] == id) return table->map_slot[b];
+  }
+  return 0;
+}
+
+static void map_insert(CompactTable *table, int id, int slot) {
+  unsigned mask = table->map_capacity - 1;
+  unsigned b = bucket_of(table, id);
+  while (table->map_slot[b] != 0) b = (b + 1) & mask;
+  table->map_id[b] = id;
+  table->map_slot[b] = slot;
+}
+
+// Rebuilds the map with `capacity` buckets
+static void map_resize(CompactTable *table, int capacity) {
+  int *old_id = table->map_id, *old_slot = table->map_slot;
+  int old_capacity = table->map_capacity;
+  table->map_capacity = capacity;
+  table->map_id = allocate_or_exit(capacity * sizeof(int));
+  table->map_slot = calloc(capacity, sizeof(int));
+  if (!table->map_slot) {
+    perror("Error allocating memory for compact page table");
+    exit(EXIT_FAILURE);
+  }
+  for (int b = 0; b < old_capacity; b++) {
+    if (old_slot[b] != 0) map_insert(table, old_id[b], old_slot[b]);
+  }
+  free(old_id);
+  free(old_slot);
+}
+
+// Removes a process from the map, shifting later entries of its probe
+// sequence back so lookups never stop at the hole
+static void map_remove(CompactTable *table, int id) {
+  unsigned mask = table->map_capacity - 1;
+  unsigned hole = bucket_of(table, id);
+  while (table->map_slot[hole] == 0 || table->map_id[hole] != id) {
+    hole = (hole + 1) & mask;
+  }
+  for (unsigned next = (hole + 1) & mask; table->map_slot[next] != 0;
+       next = (next + 1) & mask) {
+    unsigned home = bucket_of(table, table->map_id[next]);
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      table->map_id[hole] = table->map_id[next];
+      table->map_slot[hole] = table->map_slot[next];
+      hole = next;
+    }
+  }
+  table->map_slot[hole] = 0;
+}
+
+// Hands a slot to a process taking its first frames
+static int acquire_slot(CompactTable *table, int id) {
+  int slot;
+  if (table->unused_count > 0) {
+    slot = table->unused[--table->unused_count];
+  } else {
+    if (table->slot_count == table->slot_capacity) {
+      table->slot_capacity *= 2;
+      size_t bytes = table->slot_capacity * sizeof(int);
+      table->slot_owner = realloc(table->slot_owner, bytes);
+      table->slot_frames = realloc(table->slot_frames, bytes);
+      table->unused = realloc(table->unused, bytes);
+      if (!table->slot_owner || !table->slot_frames || !table->unused) {
+        perror("Error allocating memory for compact page table");
+        exit(EXIT_FAILURE);
+      }
+    }
+    slot = table->slot_count++;
+    if (slot > slot_limit(table->width)) widen(table);
+  }
+
+  // Keep the map at most half full
+  int resident = table->slot_count - 1 - table->unused_count;
+  if (2 * resident > table->map_capacity) {
+    map_resize(table, 2 * table->map_capacity);
+  }
+  map_insert(table, id, slot);
+  table->slot_owner[slot] = id;
+  table->slot_frames[slot] = 0;
+  return slot;
+}
+
+// Returns a slot whose process no longer holds any frames
+static void release_slot(CompactTable *table, int slot) {
+  map_remove(table, table->slot_owner[slot]);
+  table->unused[table->unused_count++] = slot;
+}
+
+/**
+ * Creates a compact page table with every frame free.
+ *
+ * Args:
+ *   frames (int): Number of frames of memory.
+ *
+ * Returns:
+ *   CompactTable*: The new table, with one-byte entries; release it with
+ * `compact_destroy`.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+CompactTable *compact_create(int frames) {
+  CompactTable *table = allocate_or_exit(sizeof(CompactTable));
+  table->width = 1;
+  table->frames = frames;
+  table->entries = calloc(frames > 0 ? frames : 1, 1);
+  table->slot_capacity = 16;
+  table->slot_owner = allocate_or_exit(table->slot_capacity * sizeof(int));
+  table->slot_frames = allocate_or_exit(table->slot_capacity * sizeof(int));
+  table->unused = allocate_or_exit(table->slot_capacity * sizeof(int));
+  table->slot_count = 1;  // Slot 0 stands for free frames
+  table->unused_count = 0;
+  table->map_capacity = 16;
+  table->map_id = allocate_or_exit(table->map_capacity * sizeof(int));
+  table->map_slot = calloc(table->map_capacity, sizeof(int));
+  if (!table->entries || !table->map_slot) {
+    perror("Error allocating memory for compact page table");
+    exit(EXIT_FAILURE);
+  }
+  table->slot_owner[0] = -1;
+  table->slot_frames[0] = 0;
+  return table;
+}
+
+// Allocates a copy of an array
+static void *copy_array(const void *from, size_t bytes) {
+  void *to = allocate_or_exit(bytes);
+  memcpy(to, from, bytes);
+  return to;
+}
+
+/**
+ * Copies a compact page table.
+ *
+ * Args:
+ *   table (const CompactTable*): Table to copy.
+ *
+ * Returns:
+ *   CompactTable*: An independent copy; release it with `compact_destroy`.
+ */
+CompactTable *compact_clone(const CompactTable *table) {
+  CompactTable *copy = copy_array(table, sizeof(CompactTable));
+  size_t slots = table->slot_capacity * sizeof(int);
+  size_t buckets = table->map_capacity * sizeof(int);
+  copy->entries = copy_array(table->entries,
+                             (size_t)table->frames * table->width);
+  copy->slot_owner = copy_array(table->slot_owner, slots);
+  copy->slot_frames = copy_array(table->slot_frames, slots);
+  copy->unused = copy_array(table->unused, slots);
+  copy->map_id = copy_array(table->map_id, buckets);
+  copy->map_slot = copy_array(table->map_slot, buckets);
+  return copy;
+}
+
+// Process ID owning a frame, or -1 if the frame is free
+int compact_owner(const CompactTable *table, int frame) {
+  int slot = get_entry(table, frame);
+  return slot ? table->slot_owner[slot] : -1;
+}
+
+/**
+ * Gives a range of frames to a process or frees them.
+ *
+ * Args:
+ *   table (CompactTable*): Table to update.
+ *   start (int): First frame of the range.
+ *   length (int): Number of frames in the range.
+ *   owner (int): Process ID taking the frames, or -1 to free them.
+ *
+ * Behavior:
+ *   - Hands `owner` a slot if it has none yet, and releases the slot of
+ * any process left without frames, so slots track the processes resident
+ * right now.
+ *   - Widens every entry first if the new slot does not fit.
+ */
+void compact_set(CompactTable *table, int start, int length, int owner) {
+  int slot = 0;
+  if (owner != -1) {
+    slot = lookup_slot(table, owner);
+    if (slot == 0) slot = acquire_slot(table, owner);
+  }
+
+  for (int frame = start; frame < start + length; frame++) {
+    int old = get_entry(table, frame);
+    if (old == slot) continue;
+    if (old != 0 && --table->slot_frames[old] == 0) release_slot(table, old);
+    put_entry(table, frame, slot);
+    if (slot != 0) table->slot_frames[slot]++;
+  }
+
+  if (slot != 0 && table->slot_frames[slot] == 0) release_slot(table, slot);
+}
+
+/**
+ * Finds the next frame owned by a process, or the next free frame.
+ *
+ * Args:
+ *   table (const CompactTable*): Table to search.
+ *   from (int): First frame to look at.
+ *   owner (int): Process ID to look for, or -1 for a free frame.
+ *
+ * Returns:
+ *   int: The first such frame at or after `from`, or the number of frames
+ * if there is none.
+ *
+ * Notes:
+ *   - Compares the narrow slots rather than process IDs, and answers at
+ * once for a process holding no frames.
+ */
+int compact_find(const CompactTable *table, int from, int owner) {
+  int slot = 0;
+  if (owner != -1) {
+    slot = lookup_slot(table, owner);
+    if (slot == 0) return table->frames;
+  }
+  if (from >= table->frames) return table->frames;
+
+  int frame = from;
+  switch (table->width) {
+    case 1: {
+      const uint8_t *entries = table->entries;
+      const uint8_t *hit = memchr(entries + from, slot, table->frames - from);
+      return hit ? (int)(hit - entries) : table->frames;
+    }
+    case 2: {
+      const uint16_t *entries = table->entries;
+      while (frame < table->frames && entries[frame] != slot) frame++;
+      return frame;
+    }
+    default: {
+      const uint32_t *entries = table->entries;
+      while (frame < table->frames && entries[frame] != (uint32_t)slot) {
+        frame++;
+      }
+      return frame;
+    }
+  }
+}
+
+/**
+ * Frees a compact page table.
+ *
+ * Args:
+ *   table (CompactTable*): Table from `compact_create` or `compact_clone`, or
+ * NULL.
+ */
+void compact_destroy(CompactTable *table) {
+  if (!table) return;
+  free(table->entries);
+  free(table->slot_owner);
+  free(table->slot_frames);
+  free(table->unused);
+  free(table->map_id);
+  free(table->map_slot);
+  free(table);
+}
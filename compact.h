@@ -0,0 +1,34 @@
+#ifndef COMPACT_H
+#define COMPACT_H
+
+#include <stdint.h>
+
+// Page table storing a small slot number per frame instead of a process ID.
+// Each process holding frames gets a slot (0 means free), so entries only
+// need to be wide enough for the number of processes resident at once: one
+// byte for up to 255, two for up to 65535, four beyond that. Entries are
+// widened automatically the first time a slot does not fit.
+typedef struct CompactTable {
+  void *entries;      // Slot of each frame's owner, `width` bytes each
+  int width;          // Bytes per entry (1, 2 or 4)
+  int frames;         // Number of frames
+  int *slot_owner;    // Process ID holding each slot
+  int *slot_frames;   // Frames held through each slot (0 if unused)
+  int slot_count;     // Slots handed out so far, including slot 0
+  int slot_capacity;  // Length of `slot_owner` and `slot_frames`
+  int *unused;        // Released slots, reused before new ones
+  int unused_count;   // Number of released slots
+  int *map_id;        // Open-addressed process ID -> slot map: keys...
+  int *map_slot;      // ...and slots (0 for an empty bucket)
+  int map_capacity;   // Number of buckets (a power of two)
+} CompactTable;
+
+// Function prototypes
+CompactTable *compact_create(int frames);
+CompactTable *compact_clone(const CompactTable *table);
+int compact_owner(const CompactTable *table, int frame);
+void compact_set(CompactTable *table, int start, int length, int owner);
+int compact_find(const CompactTable *table, int from, int owner);
+void compact_destroy(CompactTable *table);
+
+#endif
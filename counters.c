@@ -0,0 +1,89 @@
+#define _GNU_SOURCE
+
+#include "counters.h"
+
+#ifdef SIM_COUNTERS
+
+#include <stdio.h>
+#include <stdlib.h>
+
+Counters sim_counters;
+
+// Forwards writes to the wrapped stream, counting the bytes
+static ssize_t counting_write(void *cookie, const char *buffer, size_t size) {
+  size_t written = fwrite(buffer, 1, size, (FILE *)cookie);
+  sim_counters.output_bytes += written;
+  return written;
+}
+
+/**
+ * Wraps a stream so that every byte written through it is counted.
+ *
+ * Args:
+ *   inner (FILE*): Stream the bytes are forwarded to.
+ *
+ * Returns:
+ *   FILE*: A stream to write the event log to. Closing it flushes it but
+ * leaves `inner` open.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the stream cannot be
+ * created.
+ */
+FILE *counters_wrap_stream(FILE *inner) {
+  cookie_io_functions_t functions = {NULL, counting_write, NULL, NULL};
+  FILE *stream = fopencookie(inner, "w", functions);
+  if (!stream) {
+    perror("Error opening counting stream");
+    exit(EXIT_FAILURE);
+  }
+  return stream;
+}
+
+/**
+ * Prints the hot-path counters.
+ *
+ * Args:
+ *   out (FILE*): Stream to print to.
+ *   json (int): 1 for a single JSON object, 0 for a readable summary block.
+ */
+void print_counters(FILE *out, int json) {
+  const Counters *c = &sim_counters;
+  double per_alloc =
+      c->alloc_calls ? (double)c->alloc_pages_scanned / c->alloc_calls : 0;
+  double per_dealloc =
+      c->dealloc_calls ? (double)c->dealloc_pages_scanned / c->dealloc_calls
+                       : 0;
+
+  if (json) {
+    fprintf(out,
+            "{\"alloc_calls\": %llu, \"alloc_successes\": %llu, "
+            "\"alloc_failures\": %llu, \"alloc_pages_scanned\": %llu, "
+            "\"alloc_pages_scanned_per_call\": %.1f, "
+            "\"dealloc_calls\": %llu, \"dealloc_pages_scanned\": %llu, "
+            "\"dealloc_pages_scanned_per_call\": %.1f, "
+            "\"queue_max_depth\": %llu, \"ticks\": %llu, "
+            "\"idle_ticks\": %llu, \"output_bytes\": %llu}\n",
+            c->alloc_calls, c->alloc_successes, c->alloc_failures,
+            c->alloc_pages_scanned, per_alloc, c->dealloc_calls,
+            c->dealloc_pages_scanned, per_dealloc, c->queue_max_depth,
+            c->ticks, c->idle_ticks, c->output_bytes);
+    return;
+  }
+
+  fprintf(out, "Counters:\n");
+  fprintf(out, "  allocate_memory calls:      %llu\n", c->alloc_calls);
+  fprintf(out, "    successes:                %llu\n", c->alloc_successes);
+  fprintf(out, "    failures:                 %llu\n", c->alloc_failures);
+  fprintf(out, "    pages scanned:            %llu (%.1f per call)\n",
+          c->alloc_pages_scanned, per_alloc);
+  fprintf(out, "  deallocate_memory calls:    %llu\n", c->dealloc_calls);
+  fprintf(out, "    pages scanned:            %llu (%.1f per call)\n",
+          c->dealloc_pages_scanned, per_dealloc);
+  fprintf(out, "  input queue max depth:      %llu\n", c->queue_max_depth);
+  fprintf(out, "  ticks:                      %llu\n", c->ticks);
+  fprintf(out, "    with no events:           %llu\n", c->idle_ticks);
+  fprintf(out, "  output bytes:               %llu\n", c->output_bytes);
+}
+
+#endif
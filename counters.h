@@ -0,0 +1,47 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <stdio.h>
+
+// Hot-path counters, compiled in only when SIM_COUNTERS is defined (make
+// COUNTERS=1). Otherwise every COUNTER_* macro expands to nothing.
+#ifdef SIM_COUNTERS
+
+typedef struct {
+  unsigned long long alloc_calls;            // allocate_memory calls
+  unsigned long long alloc_successes;        // ... that placed the process
+  unsigned long long alloc_failures;         // ... that did not
+  unsigned long long alloc_pages_scanned;    // Page table entries (frames,
+                                             // runs or blocks), buddy free
+                                             // lists or free-extent treap
+                                             // nodes examined while
+                                             // allocating
+  unsigned long long dealloc_calls;          // deallocate_memory calls
+  unsigned long long dealloc_pages_scanned;  // Entries examined while freeing
+  unsigned long long queue_max_depth;        // Longest input queue seen
+  unsigned long long ticks;                  // Clock ticks simulated
+  unsigned long long idle_ticks;             // ... in which nothing happened
+  unsigned long long output_bytes;           // Bytes of event log written
+} Counters;
+
+extern Counters sim_counters;
+
+#define COUNTER_ADD(name, n) (sim_counters.name += (n))
+#define COUNTER_MAX(name, value)                                     \
+  do {                                                               \
+    if ((unsigned long long)(value) > sim_counters.name) {           \
+      sim_counters.name = (unsigned long long)(value);               \
+    }                                                                \
+  } while (0)
+
+FILE *counters_wrap_stream(FILE *inner);
+void print_counters(FILE *out, int json);
+
+#else
+
+#define COUNTER_ADD(name, n) ((void)0)
+#define COUNTER_MAX(name, value) ((void)0)
+
+#endif
+
+#endif
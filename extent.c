@@ -0,0 +1,303 @@
+#include "extent.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "counters.h"
+
+// Makes room for at least `needed` runs
+static void reserve_runs(ExtentTable *table, int needed) {
+  if (needed <= table->capacity) return;
+  int capacity = table->capacity * 2;
+  if (capacity < needed) capacity = needed;
+  Extent *runs = realloc(table->runs, capacity * sizeof(Extent));
+  if (!runs) {
+    perror("Error allocating memory for extents");
+    exit(EXIT_FAILURE);
+  }
+  table->runs = runs;
+  table->capacity = capacity;
+}
+
+// Merges neighbouring runs that ended up with the same owner
+static void merge_runs(ExtentTable *table) {
+  int kept = 0;
+  for (int i = 0; i < table->count; i++) {
+    if (kept > 0 && table->runs[kept - 1].owner == table->runs[i].owner) {
+      table->runs[kept - 1].length += table->runs[i].length;
+    } else {
+      table->runs[kept++] = table->runs[i];
+    }
+  }
+  table->count = kept;
+}
+
+/**
+ * Replaces the per-frame page table with a run-length extent table.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to an initialized `Memory` structure using
+ * ALLOC_PAGING whose page table is entirely free.
+ *
+ * Behavior:
+ *   - Frees the per-frame page table and sets `page_table` to NULL.
+ *   - Records all of memory as a single free run, so memory use grows with
+ * the number of runs rather than with the number of frames.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+void extent_init(Memory *memory) {
+  ExtentTable *table = malloc(sizeof(ExtentTable));
+  if (!table) {
+    perror("Error allocating memory for extent table");
+    exit(EXIT_FAILURE);
+  }
+  table->runs = NULL;
+  table->count = 0;
+  table->capacity = 0;
+  table->free_pages = memory->total_pages;
+
+  reserve_runs(table, 16);
+  if (memory->total_pages > 0) {
+    table->runs[0].start = 0;
+    table->runs[0].length = memory->total_pages;
+    table->runs[0].owner = -1;
+    table->count = 1;
+  }
+
+  free(memory->page_table);
+  memory->page_table = NULL;
+  memory->extents = table;
+}
+
+/**
+ * Allocates the lowest free frames to a process using the extent table.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using an extent table.
+ *   process_id (int): The ID of the process requesting memory allocation.
+ *   total_pages_needed (int): Total number of pages needed by the process.
+ *
+ * Returns:
+ *   int: 1 if memory allocation is successful, 0 if there are not enough free
+ * frames.
+ *
+ * Behavior:
+ *   - Fails immediately, without touching any run, if there are fewer free
+ * frames than needed.
+ *   - Otherwise claims free runs from the lowest address up, splitting the
+ * last one if only part of it is needed. This is the same placement that
+ * first-fit paging makes one frame at a time, in O(runs) instead of O(frames).
+ */
+int extent_allocate(Memory *memory, int process_id, int total_pages_needed) {
+  ExtentTable *table = memory->extents;
+  if (table->free_pages < total_pages_needed) {
+    return 0;  // Not enough memory, must wait
+  }
+
+  int remaining = total_pages_needed;
+  for (int i = 0; i < table->count && remaining > 0; i++) {
+    COUNTER_ADD(alloc_pages_scanned, 1);
+    Extent *run = &table->runs[i];
+    if (run->owner != -1) continue;
+
+    if (run->length > remaining) {
+      // Split off the unused tail as a new free run
+      reserve_runs(table, table->count + 1);
+      run = &table->runs[i];
+      memmove(&table->runs[i + 2], &table->runs[i + 1],
+              (table->count - i - 1) * sizeof(Extent));
+      table->runs[i + 1].start = run->start + remaining;
+      table->runs[i + 1].length = run->length - remaining;
+      table->runs[i + 1].owner = -1;
+      table->count++;
+      run->length = remaining;
+    }
+
+    run->owner = process_id;
+    set_frame_owner(memory, run->start, run->length, process_id);
+    remaining -= run->length;
+  }
+
+  table->free_pages -= total_pages_needed;
+  merge_runs(table);
+  return 1;
+}
+
+/**
+ * Frees every run owned by a process in the extent table.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using an extent table.
+ *   process_id (int): ID of the process whose memory is freed.
+ *
+ * Returns:
+ *   int: Number of frames freed.
+ *
+ * Behavior:
+ *   - Marks the process's runs free and merges them with free neighbours in a
+ * single O(runs) pass.
+ */
+int extent_deallocate(Memory *memory, int process_id) {
+  ExtentTable *table = memory->extents;
+  int frames_freed = 0;
+
+  COUNTER_ADD(dealloc_pages_scanned, table->count);
+  for (int i = 0; i < table->count; i++) {
+    if (table->runs[i].owner == process_id) {
+      table->runs[i].owner = -1;
+      set_frame_owner(memory, table->runs[i].start, table->runs[i].length, -1);
+      frames_freed += table->runs[i].length;
+    }
+  }
+
+  if (frames_freed > 0) {
+    table->free_pages += frames_freed;
+    merge_runs(table);
+  }
+  return frames_freed;
+}
+
+/**
+ * Replaces the extent table's runs, as when restoring a checkpoint.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using an extent table.
+ *   runs (const Extent*): Runs covering all of memory in frame order.
+ *   count (int): Number of runs.
+ *
+ * Behavior:
+ *   - Copies the runs, merges any adjacent runs of the same owner and keeps
+ * the free-frame summary in step.
+ */
+void extent_restore(Memory *memory, const Extent *runs, int count) {
+  ExtentTable *table = memory->extents;
+  reserve_runs(table, count);
+  memcpy(table->runs, runs, count * sizeof(Extent));
+  table->count = count;
+  table->free_pages = 0;
+  for (int i = 0; i < count; i++) {
+    if (runs[i].owner == -1) table->free_pages += runs[i].length;
+    set_frame_owner(memory, runs[i].start, runs[i].length, runs[i].owner);
+  }
+  merge_runs(table);
+}
+
+/**
+ * Finds the first run owned by a process at or after a frame.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using an extent table.
+ *   process_id (int): ID of the process whose runs are searched.
+ *   frame (int*): Frame to search from; set to the start of the run found.
+ *   length (int*): Set to the length of the run found.
+ *
+ * Returns:
+ *   int: 1 if a run was found, 0 otherwise.
+ *
+ * Behavior:
+ *   - Binary searches for the run containing `*frame`, then scans forward. A
+ * run found part way through is clipped to start at `*frame`.
+ */
+int extent_find_run(Memory *memory, int process_id, int *frame, int *length) {
+  ExtentTable *table = memory->extents;
+  int lo = 0, hi = table->count;
+  while (hi - lo > 1) {
+    int mid = (lo + hi) / 2;
+    if (table->runs[mid].start <= *frame) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+
+  for (int i = lo; i < table->count; i++) {
+    const Extent *run = &table->runs[i];
+    int end = run->start + run->length;
+    if (run->owner == process_id && end > *frame) {
+      if (run->start > *frame) *frame = run->start;
+      *length = end - *frame;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Prints the extent map with frame f starting at address (f * scale) <<
+// shift; `extent_print_map` passes constants for one of them, as the frame
+// map printer does
+static inline __attribute__((always_inline)) void extent_map_kernel(
+    Memory *memory, int scale, int shift, FILE *out) {
+  ExtentTable *table = memory->extents;
+
+  // Tracks the page numbers for processes, sized by the largest resident ID
+  int max_process_id = 0;
+  for (int i = 0; i < table->count; i++) {
+    if (table->runs[i].owner > max_process_id) {
+      max_process_id = table->runs[i].owner;
+    }
+  }
+  int *page_number = calloc(max_process_id + 1, sizeof(int));
+  if (!page_number) {
+    perror("Error allocating memory for page numbers");
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(out, "       Memory Map:\n");
+  for (int i = 0; i < table->count; i++) {
+    Extent *run = &table->runs[i];
+    if (run->owner == -1) {
+      fprintf(out, "                  %d-%d: Free frame(s)\n",
+              (run->start * scale) << shift,
+              (((run->start + run->length) * scale) << shift) - 1);
+      continue;
+    }
+
+    for (int f = run->start; f < run->start + run->length; f++) {
+      page_number[run->owner]++;
+      fprintf(out, "                  %d-%d: Process %d, Page %d\n",
+              (f * scale) << shift, (((f + 1) * scale) << shift) - 1,
+              run->owner, page_number[run->owner]);
+    }
+  }
+
+  free(page_number);
+}
+
+/**
+ * Prints the memory map from the extent table.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using an extent table.
+ *   page_size (int): Size of each page in the memory system (in KB).
+ *   out (FILE*): Stream the map is written to.
+ *
+ * Behavior:
+ *   - Produces the same lines as `print_memory_map` does for a per-frame page
+ * table, but visits each free run once instead of each free frame.
+ *   - Computes addresses with shifts when `page_size` is the memory's own
+ * power-of-two page size, and with multiplications otherwise.
+ */
+void extent_print_map(Memory *memory, int page_size, FILE *out) {
+  if (page_size == memory->page_size && memory->page_shift >= 0) {
+    extent_map_kernel(memory, 1, memory->page_shift, out);
+  } else {
+    extent_map_kernel(memory, page_size, 0, out);
+  }
+}
+
+/**
+ * Frees the extent table.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using an extent table.
+ */
+void extent_free(Memory *memory) {
+  ExtentTable *table = memory->extents;
+  if (!table) return;
+  free(table->runs);
+  free(table);
+  memory->extents = NULL;
+}
@@ -0,0 +1,31 @@
+#ifndef EXTENT_H
+#define EXTENT_H
+
+#include "memory.h"
+
+// A run of consecutive frames with the same owner
+typedef struct {
+  int start;   // First frame of the run
+  int length;  // Number of frames in the run
+  int owner;   // Process ID owning the run (-1 for free)
+} Extent;
+
+// Run-length page table: extents sorted by start frame that together cover
+// all of memory, with adjacent runs of the same owner always merged.
+typedef struct ExtentTable {
+  Extent *runs;    // Sorted runs
+  int count;       // Number of runs in use
+  int capacity;    // Number of runs allocated
+  int free_pages;  // Total number of free frames
+} ExtentTable;
+
+// Function prototypes
+void extent_init(Memory *memory);
+int extent_allocate(Memory *memory, int process_id, int total_pages_needed);
+int extent_deallocate(Memory *memory, int process_id);
+void extent_restore(Memory *memory, const Extent *runs, int count);
+int extent_find_run(Memory *memory, int process_id, int *frame, int *length);
+void extent_print_map(Memory *memory, int page_size, FILE *out);
+void extent_free(Memory *memory);
+
+#endif
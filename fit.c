@@ -0,0 +1,441 @@
+#include "fit.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "counters.h"
+#include "snapshot.h"
+
+// Orders free extents by length, breaking ties by the lower address
+static int size_less(const Fit *fit, int a, int b) {
+  if (fit->len[a] != fit->len[b]) return fit->len[a] < fit->len[b];
+  return a < b;
+}
+
+// Joins two (length, start) treaps where every key of `a` precedes `b`
+static int size_merge(Fit *fit, int a, int b) {
+  if (a == -1) return b;
+  if (b == -1) return a;
+  if (fit->priority[a] > fit->priority[b]) {
+    fit->size_right[a] = size_merge(fit, fit->size_right[a], b);
+    return a;
+  }
+  fit->size_left[b] = size_merge(fit, a, fit->size_left[b]);
+  return b;
+}
+
+// Splits a (length, start) treap into keys before `key` and the rest
+static void size_split(Fit *fit, int t, int key, int *before, int *rest) {
+  if (t == -1) {
+    *before = *rest = -1;
+  } else if (size_less(fit, t, key)) {
+    size_split(fit, fit->size_right[t], key, &fit->size_right[t], rest);
+    *before = t;
+  } else {
+    size_split(fit, fit->size_left[t], key, before, &fit->size_left[t]);
+    *rest = t;
+  }
+}
+
+static int size_remove(Fit *fit, int t, int node) {
+  if (t == node) {
+    return size_merge(fit, fit->size_left[t], fit->size_right[t]);
+  }
+  if (size_less(fit, node, t)) {
+    fit->size_left[t] = size_remove(fit, fit->size_left[t], node);
+  } else {
+    fit->size_right[t] = size_remove(fit, fit->size_right[t], node);
+  }
+  return t;
+}
+
+// Recomputes the longest extent of a start-ordered subtree
+static void addr_update(Fit *fit, int t) {
+  int best = fit->len[t];
+  int l = fit->addr_left[t], r = fit->addr_right[t];
+  if (l != -1 && fit->addr_max[l] > best) best = fit->addr_max[l];
+  if (r != -1 && fit->addr_max[r] > best) best = fit->addr_max[r];
+  fit->addr_max[t] = best;
+}
+
+static int addr_merge(Fit *fit, int a, int b) {
+  if (a == -1) return b;
+  if (b == -1) return a;
+  if (fit->priority[a] > fit->priority[b]) {
+    fit->addr_right[a] = addr_merge(fit, fit->addr_right[a], b);
+    addr_update(fit, a);
+    return a;
+  }
+  fit->addr_left[b] = addr_merge(fit, a, fit->addr_left[b]);
+  addr_update(fit, b);
+  return b;
+}
+
+static void addr_split(Fit *fit, int t, int key, int *before, int *rest) {
+  if (t == -1) {
+    *before = *rest = -1;
+  } else if (t < key) {
+    addr_split(fit, fit->addr_right[t], key, &fit->addr_right[t], rest);
+    addr_update(fit, t);
+    *before = t;
+  } else {
+    addr_split(fit, fit->addr_left[t], key, before, &fit->addr_left[t]);
+    addr_update(fit, t);
+    *rest = t;
+  }
+}
+
+static int addr_remove(Fit *fit, int t, int node) {
+  if (t == node) {
+    return addr_merge(fit, fit->addr_left[t], fit->addr_right[t]);
+  }
+  if (node < t) {
+    fit->addr_left[t] = addr_remove(fit, fit->addr_left[t], node);
+  } else {
+    fit->addr_right[t] = addr_remove(fit, fit->addr_right[t], node);
+  }
+  addr_update(fit, t);
+  return t;
+}
+
+// Lowest-addressed free extent starting at or after `from` with at least
+// `need` frames, or -1 if there is none
+static int addr_find(const Fit *fit, int t, int from, int need) {
+  if (t == -1) return -1;
+  COUNTER_ADD(alloc_pages_scanned, 1);
+  if (fit->addr_max[t] < need) return -1;
+  if (t < from) return addr_find(fit, fit->addr_right[t], from, need);
+
+  int found = addr_find(fit, fit->addr_left[t], from, need);
+  if (found != -1) return found;
+  if (fit->len[t] >= need) return t;
+  return addr_find(fit, fit->addr_right[t], from, need);
+}
+
+// Smallest free extent with at least `need` frames (lowest address on ties),
+// or -1 if there is none
+static int size_find(const Fit *fit, int need) {
+  int found = -1;
+  int t = fit->size_root;
+  while (t != -1) {
+    COUNTER_ADD(alloc_pages_scanned, 1);
+    if (fit->len[t] >= need) {
+      found = t;
+      t = fit->size_left[t];
+    } else {
+      t = fit->size_right[t];
+    }
+  }
+  return found;
+}
+
+// Records [start, start + length) as a free extent in both treaps
+static void insert_extent(Fit *fit, int start, int length) {
+  fit->len[start] = length;
+  fit->end_start[start + length - 1] = start;
+
+  fit->seed ^= fit->seed << 13;
+  fit->seed ^= fit->seed >> 17;
+  fit->seed ^= fit->seed << 5;
+  fit->priority[start] = fit->seed;
+
+  int before, rest;
+  fit->size_left[start] = fit->size_right[start] = -1;
+  size_split(fit, fit->size_root, start, &before, &rest);
+  fit->size_root = size_merge(fit, size_merge(fit, before, start), rest);
+
+  fit->addr_left[start] = fit->addr_right[start] = -1;
+  fit->addr_max[start] = length;
+  addr_split(fit, fit->addr_root, start, &before, &rest);
+  fit->addr_root = addr_merge(fit, addr_merge(fit, before, start), rest);
+}
+
+// Drops the free extent starting at `start` from both treaps
+static void remove_extent(Fit *fit, int start) {
+  fit->size_root = size_remove(fit, fit->size_root, start);
+  fit->addr_root = addr_remove(fit, fit->addr_root, start);
+  fit->end_start[start + fit->len[start] - 1] = -1;
+}
+
+/**
+ * Sets up the best-fit/next-fit allocator over the memory's frames.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to an initialized `Memory` structure whose page
+ * table is entirely free.
+ *
+ * Behavior:
+ *   - Allocates the per-frame extent arrays and records all of memory as a
+ * single free extent.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+void fit_init(Memory *memory) {
+  int total_pages = memory->total_pages;
+  Fit *fit = malloc(sizeof(Fit));
+  if (!fit) {
+    perror("Error allocating memory for fit allocator");
+    exit(EXIT_FAILURE);
+  }
+
+  fit->len = calloc(total_pages, sizeof(int));
+  fit->end_start = malloc(total_pages * sizeof(int));
+  fit->priority = malloc(total_pages * sizeof(unsigned));
+  fit->size_left = malloc(total_pages * sizeof(int));
+  fit->size_right = malloc(total_pages * sizeof(int));
+  fit->addr_left = malloc(total_pages * sizeof(int));
+  fit->addr_right = malloc(total_pages * sizeof(int));
+  fit->addr_max = malloc(total_pages * sizeof(int));
+  if (!fit->len || !fit->end_start || !fit->priority || !fit->size_left ||
+      !fit->size_right || !fit->addr_left || !fit->addr_right ||
+      !fit->addr_max) {
+    perror("Error allocating memory for fit allocator");
+    exit(EXIT_FAILURE);
+  }
+
+  for (int i = 0; i < total_pages; i++) fit->end_start[i] = -1;
+  fit->size_root = -1;
+  fit->addr_root = -1;
+  fit->cursor = 0;
+  fit->seed = 2463534242u;
+
+  memory->fit = fit;
+  if (total_pages > 0) insert_extent(fit, 0, total_pages);
+}
+
+// Returns [start, start + len[start]) to the free extents, merging it with the
+// free extents on either side. Returns the start of the merged extent.
+static int release_piece(Memory *memory, int start) {
+  Fit *fit = memory->fit;
+  int length = fit->len[start];
+
+  set_frame_owner(memory, start, length, -1);
+  fit->len[start] = 0;
+
+  // Merge with the free extent ending just below
+  if (start > 0 && frame_owner(memory, start - 1) == -1) {
+    int left = fit->end_start[start - 1];
+    length += fit->len[left];
+    remove_extent(fit, left);
+    fit->len[left] = 0;
+    start = left;
+  }
+
+  // Merge with the free extent starting just above
+  int right = start + length;
+  if (right < memory->total_pages && frame_owner(memory, right) == -1) {
+    length += fit->len[right];
+    remove_extent(fit, right);
+    fit->len[right] = 0;
+  }
+
+  insert_extent(fit, start, length);
+  return start;
+}
+
+// Claims the first `need` frames of the free extent at `start` for a process
+static void take_piece(Memory *memory, int start, int need, int process_id) {
+  Fit *fit = memory->fit;
+  int length = fit->len[start];
+
+  remove_extent(fit, start);
+  set_frame_owner(memory, start, need, process_id);
+  fit->len[start] = need;
+
+  if (length > need) {
+    insert_extent(fit, start + need, length - need);
+  }
+}
+
+/**
+ * Allocates one contiguous extent for every memory piece of a process.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using ALLOC_BEST_FIT
+ * or ALLOC_NEXT_FIT. process_id (int): The ID of the process requesting
+ * memory. num_pieces (int): Number of memory segments required by the
+ * process. piece_pages (const int*): Number of pages needed by each segment.
+ *
+ * Returns:
+ *   int: 1 if every piece was placed, 0 otherwise.
+ *
+ * Behavior:
+ *   - Best-fit takes the smallest free extent that holds the piece, preferring
+ * the lowest address among equally sized extents.
+ *   - Next-fit takes the first free extent that holds the piece at or after
+ * the end of the previous placement, wrapping around to frame 0 once.
+ *   - Pieces are placed at the low end of the chosen extent; the remainder
+ * stays free. Both searches are O(log n) in the number of free extents.
+ *   - If any piece cannot be placed, the pieces already placed by this call
+ * are released again and 0 is returned.
+ */
+int fit_allocate(Memory *memory, int process_id, int num_pieces,
+                 const int *piece_pages) {
+  Fit *fit = memory->fit;
+  int *starts = malloc((num_pieces > 0 ? num_pieces : 1) * sizeof(int));
+  if (!starts) {
+    perror("Error allocating memory for fit pieces");
+    exit(EXIT_FAILURE);
+  }
+  int saved_cursor = fit->cursor;
+
+  for (int i = 0; i < num_pieces; i++) {
+    int need = piece_pages[i] > 0 ? piece_pages[i] : 1;
+    int start;
+    if (memory->policy == ALLOC_NEXT_FIT) {
+      start = addr_find(fit, fit->addr_root, fit->cursor, need);
+      if (start == -1) start = addr_find(fit, fit->addr_root, 0, need);
+    } else {
+      start = size_find(fit, need);
+    }
+
+    if (start == -1) {
+      // Roll back the pieces placed so far
+      for (int j = i - 1; j >= 0; j--) release_piece(memory, starts[j]);
+      fit->cursor = saved_cursor;
+      free(starts);
+      return 0;
+    }
+
+    take_piece(memory, start, need, process_id);
+    starts[i] = start;
+    fit->cursor = start + need < memory->total_pages ? start + need : 0;
+  }
+
+  free(starts);
+  return 1;
+}
+
+/**
+ * Releases every extent owned by a process.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using ALLOC_BEST_FIT
+ * or ALLOC_NEXT_FIT. process_id (int): ID of the process whose pieces are
+ * freed.
+ *
+ * Returns:
+ *   int: Number of frames freed.
+ *
+ * Behavior:
+ *   - Walks memory extent by extent (not frame by frame) and releases the
+ * pieces owned by `process_id`, coalescing them with adjacent free extents.
+ */
+int fit_deallocate(Memory *memory, int process_id) {
+  Fit *fit = memory->fit;
+  int frames_freed = 0;
+
+  int frame = 0;
+  while (frame < memory->total_pages) {
+    COUNTER_ADD(dealloc_pages_scanned, 1);
+    if (frame_owner(memory, frame) == process_id) {
+      frames_freed += fit->len[frame];
+      // The merged extent may start below this piece; resume after all of it
+      frame = release_piece(memory, frame);
+    }
+    frame += fit->len[frame];
+  }
+  return frames_freed;
+}
+
+/**
+ * Writes the best-fit/next-fit allocator's pieces to a checkpoint.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using ALLOC_BEST_FIT
+ * or ALLOC_NEXT_FIT.
+ *   file (FILE*): Checkpoint being written.
+ *
+ * Behavior:
+ *   - Writes the next-fit cursor and the length of every free extent and
+ * allocated piece from the lowest frame up. Allocated pieces of one process
+ * can be adjacent, so their boundaries are not implied by the frame owners.
+ */
+void fit_save(Memory *memory, FILE *file) {
+  Fit *fit = memory->fit;
+  snapshot_write_int(file, fit->cursor);
+  snapshot_write_int(file, fit->seed);
+
+  int pieces = 0;
+  for (int frame = 0; frame < memory->total_pages; frame += fit->len[frame]) {
+    pieces++;
+  }
+  snapshot_write_int(file, pieces);
+  for (int frame = 0; frame < memory->total_pages; frame += fit->len[frame]) {
+    snapshot_write_int(file, fit->len[frame]);
+  }
+}
+
+/**
+ * Rebuilds the best-fit/next-fit allocator from a checkpoint.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using ALLOC_BEST_FIT
+ * or ALLOC_NEXT_FIT, with the checkpoint's frame owners already restored.
+ *   file (FILE*): Checkpoint positioned after the frame owners.
+ *
+ * Notes:
+ *   - The treaps are rebuilt with fresh priorities. Their shape may differ
+ * from the saved run's, but both searches depend only on the keys, so the
+ * restored allocator makes the same placements.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the pieces do not fit this
+ * memory.
+ */
+void fit_restore(Memory *memory, FILE *file) {
+  Fit *fit = memory->fit;
+  for (int i = 0; i < memory->total_pages; i++) {
+    fit->len[i] = 0;
+    fit->end_start[i] = -1;
+  }
+  fit->size_root = -1;
+  fit->addr_root = -1;
+  fit->cursor = snapshot_read_int(file);
+  unsigned seed = snapshot_read_int(file);
+  if (fit->cursor < 0 || fit->cursor > memory->total_pages) {
+    snapshot_fail("next-fit cursor outside memory");
+  }
+
+  int pieces = snapshot_read_int(file);
+  int frame = 0;
+  for (int i = 0; i < pieces; i++) {
+    int length = snapshot_read_int(file);
+    if (length <= 0 || frame + length > memory->total_pages) {
+      snapshot_fail("fit pieces do not fit memory");
+    }
+    if (frame_owner(memory, frame) == -1) {
+      insert_extent(fit, frame, length);
+    } else {
+      fit->len[frame] = length;
+    }
+    frame += length;
+  }
+  if (frame != memory->total_pages) {
+    snapshot_fail("fit pieces do not cover memory");
+  }
+  fit->seed = seed;
+}
+
+/**
+ * Frees the best-fit/next-fit allocator's bookkeeping.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure using ALLOC_BEST_FIT
+ * or ALLOC_NEXT_FIT.
+ */
+void fit_free(Memory *memory) {
+  Fit *fit = memory->fit;
+  if (!fit) return;
+  free(fit->len);
+  free(fit->end_start);
+  free(fit->priority);
+  free(fit->size_left);
+  free(fit->size_right);
+  free(fit->addr_left);
+  free(fit->addr_right);
+  free(fit->addr_max);
+  free(fit);
+  memory->fit = NULL;
+}
@@ -0,0 +1,36 @@
+#ifndef FIT_H
+#define FIT_H
+
+#include "memory.h"
+
+// Bookkeeping for the best-fit and next-fit contiguous allocators. Free
+// extents are nodes of two treaps, one ordered by (length, start) for best-fit
+// and one ordered by start for next-fit. Nodes are identified by the frame
+// their extent starts at, so all per-node arrays are indexed by frame.
+typedef struct Fit {
+  int *len;            // Length of the free extent or allocated piece starting
+                       // at each frame (0 if the frame starts neither)
+  int *end_start;      // Start of the free extent ending at each frame (-1 if
+                       // no free extent ends there)
+  unsigned *priority;  // Treap priority of each free extent
+  int *size_left;      // Children in the (length, start) treap
+  int *size_right;
+  int size_root;
+  int *addr_left;  // Children in the start-ordered treap
+  int *addr_right;
+  int *addr_max;  // Longest free extent in each start-ordered subtree
+  int addr_root;
+  int cursor;     // Frame where the next next-fit search begins
+  unsigned seed;  // State of the priority generator
+} Fit;
+
+// Function prototypes
+void fit_init(Memory *memory);
+int fit_allocate(Memory *memory, int process_id, int num_pieces,
+                 const int *piece_pages);
+int fit_deallocate(Memory *memory, int process_id);
+void fit_save(Memory *memory, FILE *file);
+void fit_restore(Memory *memory, FILE *file);
+void fit_free(Memory *memory);
+
+#endif
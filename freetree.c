@@ -0,0 +1,309 @@
+#include "freetree.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Marks every frame of a node covering `length` frames free or in use. A
+// leaf's bits are left to `materialize`.
+static void fill_node(FreeTree *tree, int node, int length, int is_free) {
+  int value = is_free ? length : 0;
+  tree->free[node] = value;
+  tree->prefix[node] = value;
+  tree->suffix[node] = value;
+  tree->longest[node] = value;
+  tree->runs[node] = is_free && length > 0;
+  tree->lazy[node] = is_free;
+}
+
+// Recomputes a node covering `length` frames from its two children
+static void pull_up(FreeTree *tree, int node, int length) {
+  int l = 2 * node, r = 2 * node + 1, half = length / 2;
+  tree->free[node] = tree->free[l] + tree->free[r];
+  tree->prefix[node] = tree->prefix[l] == half ? half + tree->prefix[r]
+                                               : tree->prefix[l];
+  tree->suffix[node] = tree->suffix[r] == half ? half + tree->suffix[l]
+                                               : tree->suffix[r];
+
+  int longest = tree->suffix[l] + tree->prefix[r];
+  if (tree->longest[l] > longest) longest = tree->longest[l];
+  if (tree->longest[r] > longest) longest = tree->longest[r];
+  tree->longest[node] = longest;
+
+  // A free run crossing the midpoint is counted once, not twice
+  tree->runs[node] = tree->runs[l] + tree->runs[r] -
+                     (tree->suffix[l] > 0 && tree->prefix[r] > 0);
+  tree->lazy[node] = -1;
+}
+
+static void push_down(FreeTree *tree, int node, int length) {
+  if (tree->lazy[node] == -1) return;
+  fill_node(tree, 2 * node, length / 2, tree->lazy[node]);
+  fill_node(tree, 2 * node + 1, length / 2, tree->lazy[node]);
+  tree->lazy[node] = -1;
+}
+
+// Bits of the block a leaf covers
+static uint64_t *block_bits(const FreeTree *tree, int node) {
+  return tree->bits + (size_t)(node - tree->leaves) * FREE_TREE_WORDS;
+}
+
+// Writes a leaf's pending assignment to its bits
+static void materialize(FreeTree *tree, int node) {
+  if (tree->lazy[node] == -1) return;
+  uint64_t *words = block_bits(tree, node);
+  for (int w = 0; w < FREE_TREE_WORDS; w++) {
+    words[w] = tree->lazy[node] ? ~0ULL : 0;
+  }
+  tree->lazy[node] = -1;
+}
+
+// Sets (or clears) bits `from` up to `to` - 1 of a block
+static void set_bits(uint64_t *words, int from, int to, int is_free) {
+  while (from < to) {
+    int bit = from % 64;
+    int count = to - from < 64 - bit ? to - from : 64 - bit;
+    uint64_t mask = (count == 64 ? ~0ULL : (1ULL << count) - 1) << bit;
+    if (is_free) {
+      words[from / 64] |= mask;
+    } else {
+      words[from / 64] &= ~mask;
+    }
+    from += count;
+  }
+}
+
+// First bit at or after `from` in a block that is set (or clear), or
+// FREE_TREE_BLOCK if there is none
+static int scan_bits(const uint64_t *words, int from, int is_free) {
+  for (int w = from / 64; w < FREE_TREE_WORDS; w++) {
+    uint64_t word = is_free ? words[w] : ~words[w];
+    if (w == from / 64) word &= ~0ULL << (from % 64);
+    if (word) return w * 64 + __builtin_ctzll(word);
+  }
+  return FREE_TREE_BLOCK;
+}
+
+// Longest run of set bits in a word, in O(log 64) steps: bit p of run[j] is
+// set when bits p to p + 2^j - 1 all are, and the length is then refined
+// one power of two at a time
+static int longest_ones(uint64_t word) {
+  if (!word) return 0;
+  uint64_t run[7];
+  run[0] = word;
+  int j = 0;
+  while (j < 6 && (run[j] & (run[j] >> (1 << j)))) {
+    run[j + 1] = run[j] & (run[j] >> (1 << j));
+    j++;
+  }
+  uint64_t starts = run[j];
+  int length = 1 << j;
+  for (int k = j - 1; k >= 0 && length < 64; k--) {
+    uint64_t longer = starts & (run[k] >> length);
+    if (longer) {
+      starts = longer;
+      length += 1 << k;
+    }
+  }
+  return length;
+}
+
+// Recomputes a leaf from its bits a word at a time, however fragmented the
+// block is
+static void summarize_leaf(FreeTree *tree, int node) {
+  const uint64_t *words = block_bits(tree, node);
+  int free = 0, prefix = 0, longest = 0, runs = 0;
+  int tail = 0;       // Free run ending at the current word
+  int in_prefix = 1;  // Whether every word so far is entirely free
+  uint64_t carry = 0;
+  for (int w = 0; w < FREE_TREE_WORDS; w++) {
+    uint64_t word = words[w];
+    free += __builtin_popcountll(word);
+    runs += __builtin_popcountll(word & ~((word << 1) | carry));
+    carry = word >> 63;
+    if (word == ~0ULL) {
+      tail += 64;
+      if (in_prefix) prefix += 64;
+    } else {
+      int low = __builtin_ctzll(~word);
+      if (in_prefix) prefix += low;
+      in_prefix = 0;
+      if (tail + low > longest) longest = tail + low;
+      int inner = longest_ones(word);
+      if (inner > longest) longest = inner;
+      tail = __builtin_clzll(~word);
+    }
+    if (tail > longest) longest = tail;
+  }
+  tree->free[node] = free;
+  tree->prefix[node] = prefix;
+  tree->suffix[node] = tail;
+  tree->longest[node] = longest;
+  tree->runs[node] = runs;
+  tree->lazy[node] = -1;
+}
+
+// Blocks wholly inside memory start out free without touching their bits;
+// the last, partial block gets its bits written
+static void build(FreeTree *tree, int node, int lo, int length) {
+  if (length == FREE_TREE_BLOCK) {
+    if (lo + length <= tree->frames) {
+      fill_node(tree, node, length, 1);
+    } else {
+      int free = tree->frames > lo ? tree->frames - lo : 0;
+      set_bits(block_bits(tree, node), 0, free, 1);
+      summarize_leaf(tree, node);
+    }
+    return;
+  }
+  build(tree, 2 * node, lo, length / 2);
+  build(tree, 2 * node + 1, lo + length / 2, length / 2);
+  pull_up(tree, node, length);
+}
+
+static void assign(FreeTree *tree, int node, int lo, int length, int start,
+                   int end, int is_free) {
+  if (end <= lo || lo + length <= start) return;
+  if (start <= lo && lo + length <= end) {
+    fill_node(tree, node, length, is_free);
+    return;
+  }
+  if (length == FREE_TREE_BLOCK) {
+    materialize(tree, node);
+    int from = start > lo ? start - lo : 0;
+    int to = end < lo + length ? end - lo : length;
+    set_bits(block_bits(tree, node), from, to, is_free);
+    summarize_leaf(tree, node);
+    return;
+  }
+  push_down(tree, node, length);
+  assign(tree, 2 * node, lo, length / 2, start, end, is_free);
+  assign(tree, 2 * node + 1, lo + length / 2, length / 2, start, end,
+         is_free);
+  pull_up(tree, node, length);
+}
+
+// First frame at or after `from` in a node's range that is free (or in use),
+// or -1 if there is none. Only mixed nodes are descended into, and a pending
+// assignment always sits on a uniform node, so children and bits are never
+// stale.
+static int find(const FreeTree *tree, int node, int lo, int length, int from,
+                int is_free) {
+  if (lo + length <= from) return -1;
+  int wanted = is_free ? tree->free[node] : length - tree->free[node];
+  if (wanted == 0) return -1;
+  if (wanted == length) return lo > from ? lo : from;
+
+  if (length == FREE_TREE_BLOCK) {
+    int at = scan_bits(block_bits(tree, node), from > lo ? from - lo : 0,
+                       is_free);
+    return at < FREE_TREE_BLOCK ? lo + at : -1;
+  }
+
+  int half = length / 2;
+  int found = find(tree, 2 * node, lo, half, from, is_free);
+  if (found != -1) return found;
+  return find(tree, 2 * node + 1, lo + half, half, from, is_free);
+}
+
+/**
+ * Creates a free-frame tree with every frame free.
+ *
+ * Args:
+ *   frames (int): Number of frames of memory.
+ *
+ * Returns:
+ *   FreeTree*: The new tree; release it with `free_tree_destroy`.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+FreeTree *free_tree_create(int frames) {
+  FreeTree *tree = malloc(sizeof(FreeTree));
+  if (!tree) {
+    perror("Error allocating memory for free-frame tree");
+    exit(EXIT_FAILURE);
+  }
+  tree->frames = frames;
+  tree->leaves = 1;
+  while ((long)tree->leaves * FREE_TREE_BLOCK < frames) tree->leaves *= 2;
+
+  int nodes = 2 * tree->leaves;
+  tree->bits =
+      calloc((size_t)tree->leaves * FREE_TREE_WORDS, sizeof(uint64_t));
+  tree->free = malloc(nodes * sizeof(int));
+  tree->prefix = malloc(nodes * sizeof(int));
+  tree->suffix = malloc(nodes * sizeof(int));
+  tree->longest = malloc(nodes * sizeof(int));
+  tree->runs = malloc(nodes * sizeof(int));
+  tree->lazy = malloc(nodes * sizeof(signed char));
+  if (!tree->bits || !tree->free || !tree->prefix || !tree->suffix ||
+      !tree->longest || !tree->runs || !tree->lazy) {
+    perror("Error allocating memory for free-frame tree");
+    exit(EXIT_FAILURE);
+  }
+
+  build(tree, 1, 0, tree->leaves * FREE_TREE_BLOCK);
+  return tree;
+}
+
+/**
+ * Marks a range of frames free or in use.
+ *
+ * Args:
+ *   tree (FreeTree*): Tree to update.
+ *   start (int): First frame of the range.
+ *   length (int): Number of frames in the range.
+ *   is_free (int): 1 to mark the frames free, 0 to mark them in use.
+ *
+ * Notes:
+ *   - Runs in O(log frames) however long the range is, plus a pass over the
+ * bits of the at most two blocks the range covers only in part; the root's
+ * fields then describe all of memory.
+ */
+void free_tree_set(FreeTree *tree, int start, int length, int is_free) {
+  if (length <= 0) return;
+  assign(tree, 1, 0, tree->leaves * FREE_TREE_BLOCK, start, start + length,
+         is_free);
+}
+
+/**
+ * Finds the next free (or in-use) frame.
+ *
+ * Args:
+ *   tree (const FreeTree*): Tree to search.
+ *   from (int): First frame to look at.
+ *   is_free (int): 1 to look for a free frame, 0 for a frame in use.
+ *
+ * Returns:
+ *   int: The first such frame at or after `from`, or the number of frames if
+ * there is none.
+ *
+ * Notes:
+ *   - Runs in O(log frames): whole ranges with no frame in the wanted state,
+ * such as a long fully allocated prefix, are skipped at once, and the bits
+ * of at most two blocks are scanned a word at a time.
+ */
+int free_tree_find(const FreeTree *tree, int from, int is_free) {
+  if (from >= tree->frames) return tree->frames;
+  int found =
+      find(tree, 1, 0, tree->leaves * FREE_TREE_BLOCK, from, is_free);
+  return found == -1 || found > tree->frames ? tree->frames : found;
+}
+
+/**
+ * Frees a free-frame tree.
+ *
+ * Args:
+ *   tree (FreeTree*): Tree from `free_tree_create`, or NULL.
+ */
+void free_tree_destroy(FreeTree *tree) {
+  if (!tree) return;
+  free(tree->bits);
+  free(tree->free);
+  free(tree->prefix);
+  free(tree->suffix);
+  free(tree->longest);
+  free(tree->runs);
+  free(tree->lazy);
+  free(tree);
+}
@@ -0,0 +1,35 @@
+#ifndef FREETREE_H
+#define FREETREE_H
+
+#include <stdint.h>
+
+// Frames summarized by each leaf of a free-frame tree
+#define FREE_TREE_BLOCK 512
+#define FREE_TREE_WORDS (FREE_TREE_BLOCK / 64)
+
+// Free-frame summary: a bitmap with one bit per frame, and a segment tree
+// whose leaves are blocks of FREE_TREE_BLOCK frames. Every node covers a
+// power-of-two number of blocks (frames past the end of memory count as in
+// use), so node 1 summarizes all of memory. The tree costs a few bytes per
+// block, so the whole summary takes about one bit per frame.
+typedef struct FreeTree {
+  int frames;         // Number of frames covered
+  int leaves;         // Power of two >= the number of blocks
+  uint64_t *bits;     // Set for each free frame, FREE_TREE_WORDS per block
+                      // (stale under a pending assignment)
+  int *free;          // Free frames in the node's range
+  int *prefix;        // Free frames at the low end of the range
+  int *suffix;        // Free frames at the high end of the range
+  int *longest;       // Longest run of free frames within the range
+  int *runs;          // Number of maximal free runs within the range
+  signed char *lazy;  // Pending assignment to the node's children, or to a
+                      // leaf's bits (1 free, 0 in use, -1 none)
+} FreeTree;
+
+// Function prototypes
+FreeTree *free_tree_create(int frames);
+void free_tree_set(FreeTree *tree, int start, int length, int is_free);
+int free_tree_find(const FreeTree *tree, int from, int is_free);
+void free_tree_destroy(FreeTree *tree);
+
+#endif
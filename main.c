@@ -1,26 +1,71 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include "branch.h"
+#include "cluster.h"
+#include "counters.h"
 #include "memory.h"
 #include "parser.h"
-#include "scheduler.h"
-
-// Function to print the current state of the input queue
-void print_input_queue(InputQueue *queue) {
-  printf("       Input Queue:[");
-  QueueNode *node = queue->front;
-  while (node) {
-    printf("%d", node->process.id);
-    if (node->next) printf(" ");
-    node = node->next;
+#include "shard.h"
+#include "simulator.h"
+#include "timing.h"
+#include "trace.h"
+
+/**
+ * Finishes a simulation once per admission policy, each in its own branch.
+ *
+ * Args:
+ *   sim (Simulator*): Simulation to branch from; left where it is.
+ *   log (FILE*): Stream the branch summaries are written to.
+ *   stats_json (int): Statistics format for each branch (-1 for none, 0 for
+ * text, 1 for JSON), printed to stderr.
+ *
+ * Behavior:
+ *   - Branches share the warm state copy-on-write (see `branch_open`) and run
+ * to the end at OUTPUT_QUIET, so no event or map is formatted, then print a
+ * "Branch <policy> after t = <tick>:" line followed by their average
+ * turnaround time unless `sim` itself is quiet.
+ */
+static void run_what_if(Simulator *sim, FILE *log, int stats_json) {
+  BranchImage image;
+  branch_image_create(&image, sim);
+  AdmissionPolicy policies[] = {ADMIT_FCFS, ADMIT_BACKFILL};
+  for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++) {
+    Simulator branch;
+    branch_open(&image, sim, &branch, log);
+    sim_set_admission(&branch, policies[p]);
+    branch.output = OUTPUT_QUIET;
+    sim_run(&branch, SIM_END_TIME);
+
+    const char *name = admission_policy_name(policies[p]);
+    if (sim->output >= OUTPUT_SUMMARY) {
+      fprintf(log, "\nBranch %s after t = %d:", name, sim->clock - 1);
+    }
+    branch.output = sim->output;
+    sim_print_summary(&branch);
+    if (stats_json != -1) {
+      fflush(log);
+      if (!stats_json) fprintf(stderr, "Branch %s:\n", name);
+      sim_print_stats(&branch, stderr, stats_json);
+    }
+    branch_close(&image, &branch);
   }
-  printf("]\n");
+  branch_image_destroy(&image);
 }
 
 int main(int argc, char *argv[]) {
   if (argc <
       4) {  // Ensure there are 3 arguments: input_file, total_memory, page_size
-    fprintf(stderr, "Usage: %s <input_file> <total_memory_size> <page_size>\n",
+    fprintf(stderr,
+            "Usage: %s <input_file> <total_memory_size> <page_size> "
+            "[--alloc=paging|buddy|best-fit|next-fit] [--extents] [--compact] "
+            "[--shards=S] [--shard-policy=local|interleave|spill] "
+            "[--counters=text|json] [--trace=jsonl|csv|binary] "
+            "[--stats[=text|json]] [--checkpoint=T:PATH] [--restore=PATH] "
+            "[--admission=fcfs|backfill] [--what-if=T] "
+            "[--quiet|--summary|--events|--full-maps] [--hosts=H] "
+            "[--route=round-robin|least-loaded|best-fit] [--threads=N]\n",
             argv[0]);
     return EXIT_FAILURE;
   }
@@ -29,6 +74,99 @@ int main(int argc, char *argv[]) {
   const char *input_file = argv[1];
   int total_memory = atoi(argv[2]);
   int page_size = atoi(argv[3]);
+  AllocPolicy policy = ALLOC_PAGING;
+  int extents = 0;
+  int compact = 0;
+  int shards = 0;  // Number of NUMA shards (0 to leave memory unsplit)
+  ShardPolicy shard_policy = SHARD_LOCAL;
+  int counters_json = -1;  // Counter format (-1 for the default)
+  int stats_json = -1;  // Statistics format (-1 for none)
+  int tracing = 0;
+  int checkpoint_time = -1;  // Tick after which to checkpoint (-1 for none)
+  const char *checkpoint_path = NULL;
+  const char *restore_path = NULL;
+  AdmissionPolicy admission = ADMIT_FCFS;
+  int what_if_time = -1;  // Tick after which to branch (-1 for none)
+  OutputLevel output = OUTPUT_FULL_MAPS;
+  int hosts = 0;    // Hosts of a simulated cluster (0 for a single host)
+  int threads = 0;  // Threads advancing cluster hosts (0 for one per CPU)
+  RoutePolicy route = ROUTE_ROUND_ROBIN;
+  TraceFormat trace_format = TRACE_JSONL;
+
+  // Parse optional flags following the required arguments
+  for (int i = 4; i < argc; i++) {
+    if (strncmp(argv[i], "--alloc=", 8) == 0 &&
+        parse_alloc_policy(argv[i] + 8, &policy)) {
+      continue;
+    }
+    if (strcmp(argv[i], "--extents") == 0) {
+      extents = 1;
+      continue;
+    }
+    if (strcmp(argv[i], "--compact") == 0) {
+      compact = 1;
+      continue;
+    }
+    if (strncmp(argv[i], "--shards=", 9) == 0) {
+      shards = atoi(argv[i] + 9);
+      if (shards > 0) continue;
+    }
+    if (strncmp(argv[i], "--shard-policy=", 15) == 0 &&
+        parse_shard_policy(argv[i] + 15, &shard_policy)) {
+      continue;
+    }
+    if (strcmp(argv[i], "--counters=text") == 0 ||
+        strcmp(argv[i], "--counters=json") == 0) {
+      counters_json = strcmp(argv[i], "--counters=json") == 0;
+      continue;
+    }
+    if (strcmp(argv[i], "--stats") == 0 ||
+        strcmp(argv[i], "--stats=text") == 0 ||
+        strcmp(argv[i], "--stats=json") == 0) {
+      stats_json = strcmp(argv[i], "--stats=json") == 0;
+      continue;
+    }
+    if (strncmp(argv[i], "--checkpoint=", 13) == 0) {
+      char *colon = strchr(argv[i] + 13, ':');
+      checkpoint_time = atoi(argv[i] + 13);
+      if (colon && colon[1] != '\0' && checkpoint_time >= 0) {
+        checkpoint_path = colon + 1;
+        continue;
+      }
+    }
+    if (strncmp(argv[i], "--restore=", 10) == 0 && argv[i][10] != '\0') {
+      restore_path = argv[i] + 10;
+      continue;
+    }
+    if (strncmp(argv[i], "--admission=", 12) == 0 &&
+        parse_admission_policy(argv[i] + 12, &admission)) {
+      continue;
+    }
+    if (strncmp(argv[i], "--what-if=", 10) == 0 && argv[i][10] != '\0') {
+      what_if_time = atoi(argv[i] + 10);
+      if (what_if_time >= 0) continue;
+    }
+    if (parse_output_level(argv[i], &output)) continue;
+    if (strncmp(argv[i], "--hosts=", 8) == 0) {
+      hosts = atoi(argv[i] + 8);
+      if (hosts > 0) continue;
+    }
+    if (strncmp(argv[i], "--route=", 8) == 0 &&
+        parse_route_policy(argv[i] + 8, &route)) {
+      continue;
+    }
+    if (strncmp(argv[i], "--threads=", 10) == 0) {
+      threads = atoi(argv[i] + 10);
+      if (threads > 0) continue;
+    }
+    if (strncmp(argv[i], "--trace=", 8) == 0 &&
+        parse_trace_format(argv[i] + 8, &trace_format)) {
+      tracing = 1;
+      continue;
+    }
+    fprintf(stderr, "Error: Unknown option '%s'.\n", argv[i]);
+    return EXIT_FAILURE;
+  }
 
   if (total_memory <= 0 || page_size <= 0 || total_memory % page_size != 0) {
     fprintf(stderr,
@@ -37,118 +175,169 @@ int main(int argc, char *argv[]) {
     return EXIT_FAILURE;
   }
 
+  if (what_if_time >= 0 && tracing) {
+    fprintf(stderr, "Error: --what-if cannot be combined with --trace.\n");
+    return EXIT_FAILURE;
+  }
+
+  if (hosts > 0 && (tracing || checkpoint_path || restore_path ||
+                    what_if_time >= 0 || shards > 0)) {
+    fprintf(stderr,
+            "Error: --hosts cannot be combined with --trace, --checkpoint, "
+            "--restore, --what-if or --shards.\n");
+    return EXIT_FAILURE;
+  }
+
+  if (shards > 0 && (extents || what_if_time >= 0)) {
+    fprintf(stderr,
+            "Error: --shards cannot be combined with --extents or "
+            "--what-if.\n");
+    return EXIT_FAILURE;
+  }
+
+#ifndef SIM_COUNTERS
+  if (counters_json != -1) {
+    fprintf(stderr,
+            "Error: --counters needs a build with counters (make "
+            "COUNTERS=1).\n");
+    return EXIT_FAILURE;
+  }
+#endif
+
   // Parse input file and initialize structures
+  TIMER_START(parse_start);
   int num_processes;
   Process *processes = parse_input_file(input_file, &num_processes);
 
-  // Explicitly initialize start_time to -1 for all processes
-  for (int i = 0; i < num_processes; i++) {
-    processes[i].start_time =
-        -1;  // Ensure all start times are marked as "not started"
-  }
+  // Cache each process's page demand for this page size
+  compute_page_demand(processes, num_processes, page_size);
+  TIMER_STOP(TIMER_PARSE, parse_start);
 
   // Initialize memory with total size and page size from arguments
   Memory memory;
-  init_memory(&memory, total_memory, page_size);
-
-  InputQueue queue;
-  init_queue(&queue);
-
-  int clock = 0;
-  double total_turnaround = 0;
-  int completed_processes = 0;
-
-  while (clock <= 100000) {
-    int event_occurred = 0;
-
-    // Dynamically enqueue processes based on arrival time
-    for (int i = 0; i < num_processes; i++) {
-      if (processes[i].arrival_time == clock) {
-        if (!event_occurred) {
-          printf("\nt = %d:\n", clock);
-          event_occurred = 1;
-        }
-        enqueue(&queue, processes[i]);
-        printf("       Process %d arrives\n", processes[i].id);
-
-        // Print input queue state
-        print_input_queue(&queue);
-      }
-    }
+  init_memory_policy(&memory, total_memory, page_size, policy);
+  if (extents && !use_extent_table(&memory)) {
+    fprintf(stderr, "Error: --extents only supports --alloc=paging.\n");
+    free_parsed_data(processes, num_processes);
+    free_memory(&memory);
+    return EXIT_FAILURE;
+  }
+  if (shards > 0 && !shard_split(&memory, shards, shard_policy)) {
+    fprintf(stderr,
+            "Error: --shards must divide the %d frames of memory evenly.\n",
+            memory.total_pages);
+    free_parsed_data(processes, num_processes);
+    free_memory(&memory);
+    return EXIT_FAILURE;
+  }
+  if (compact && !use_compact_table(&memory)) {
+    fprintf(stderr, "Error: --compact cannot be combined with --extents.\n");
+    free_parsed_data(processes, num_processes);
+    free_memory(&memory);
+    return EXIT_FAILURE;
+  }
 
-    // Check for process completions (FCFS order for same completion time)
-    for (int i = 0; i < num_processes; i++) {
-      Process *process = &processes[i];
+  // Count the bytes of event log written and time writing them when
+  // counters or timing are compiled in
+  FILE *log = stdout;
+#ifdef SIM_TIMING
+  FILE *timed_log = log = timing_wrap_stream(log);
+#endif
+#ifdef SIM_COUNTERS
+  log = counters_wrap_stream(log);
+#endif
 
-      // Only consider completion if the process has actually started
-      if (process->start_time != -1) {
-        int completion_time = process->start_time + process->lifetime;
-        if (completion_time == clock) {
-          if (!event_occurred) {
-            printf("\nt = %d:\n", clock);
-            event_occurred = 1;
-          }
-          printf("       Process %d completes\n", process->id);
-          deallocate_memory(&memory, process->id);
+  if (hosts > 0) {
+    // Route the processes over independent hosts shaped like `memory`
+    ProcessTable jobs;
+    process_table_build(&jobs, processes, num_processes);
+    Cluster cluster;
+    cluster_init(&cluster, hosts, &memory, route, threads);
+    for (int h = 0; h < hosts; h++) {
+      cluster.hosts[h].admission = admission;
+    }
+    cluster_run(&cluster, &jobs, SIM_END_TIME);
+    cluster_print_summary(&cluster, log, output);
+    if (stats_json != -1) {
+      fflush(log);
+      cluster_print_stats(&cluster, stderr, stats_json);
+    }
+    cluster_free(&cluster);
+    process_table_free(&jobs);
+  } else {
+    Simulator sim;
+    sim_init(&sim, processes, num_processes, &memory, log);
+    sim.admission = admission;
+    sim.output = output;
 
-          // Print memory map after deallocation
-          print_memory_map(&memory, memory.page_size);
+    // Write structured records instead of the text log when asked to
+    TraceWriter trace;
+    if (tracing) {
+      trace_open(&trace, log, trace_format);
+      sim.trace = &trace;
+    }
 
-          total_turnaround += (clock - process->arrival_time);
-          completed_processes++;
-        }
+    // Resume from a checkpoint, replacing the fresh state set up above
+    if (restore_path) {
+      FILE *file = fopen(restore_path, "rb");
+      if (!file) {
+        perror("Error opening checkpoint");
+        return EXIT_FAILURE;
       }
+      sim_restore(&sim, file);
+      fclose(file);
     }
 
-    // Attempt to allocate memory for processes in the queue
-    while (!is_queue_empty(&queue)) {
-      Process next_process = queue.front->process;
-
-      // Allocate memory if possible
-      if (allocate_memory(&memory, next_process.id, next_process.memory_pieces,
-                          next_process.piece_sizes)) {
-        // Mark the start time for this process
-        for (int p = 0; p < num_processes; p++) {
-          if (processes[p].id == next_process.id) {
-            processes[p].start_time = clock;  // Process starts now
-            break;
-          }
-        }
-
-        if (!event_occurred) {
-          printf("\nt = %d:\n", clock);
-          event_occurred = 1;
-        }
-        dequeue(&queue);
-        printf("       MM moves Process %d to memory\n", next_process.id);
-
-        // Print input queue state
-        print_input_queue(&queue);
-
-        // Print memory map after allocation
-        print_memory_map(&memory, memory.page_size);
-
-      } else {
-        // Cannot allocate the next process yet, break to move time forward
-        break;
+    // Checkpoint between ticks, then carry on with the same run
+    if (checkpoint_path && checkpoint_time >= sim.clock) {
+      sim_run(&sim, checkpoint_time);
+      FILE *file = fopen(checkpoint_path, "wb");
+      if (!file) {
+        perror("Error creating checkpoint");
+        return EXIT_FAILURE;
+      }
+      sim_save(&sim, file);
+      if (fclose(file) != 0) {
+        perror("Error writing checkpoint");
+        return EXIT_FAILURE;
       }
     }
 
-    // Increment clock
-    clock++;
+    if (what_if_time >= 0) {
+      // Branch from the warm state once per admission policy and compare
+      // how each finishes
+      sim_run(&sim, what_if_time);
+      run_what_if(&sim, log, stats_json);
+    } else {
+      sim_run(&sim, SIM_END_TIME);
+      sim_print_summary(&sim);
+      if (stats_json != -1) {
+        fflush(log);
+        sim_print_stats(&sim, stderr, stats_json);
+      }
+    }
+    sim_free(&sim);
+    if (tracing) trace_close(&trace);
   }
 
-  // Calculate and print the average turnaround time
-  if (completed_processes > 0) {
-    printf("\nAverage Turnaround Time: %.2f\n",
-           total_turnaround / completed_processes);
-  } else {
-    printf("No processes completed. Average Turnaround Time: N/A\n");
-  }
+  // Close the wrappers outermost first so each flushes into the next
+#ifdef SIM_COUNTERS
+  fclose(log);
+#endif
+#ifdef SIM_TIMING
+  fclose(timed_log);
+#endif
+  fflush(stdout);
+#ifdef SIM_COUNTERS
+  print_counters(stderr, counters_json == 1);
+#endif
+#ifdef SIM_TIMING
+  print_timing(stderr);
+#endif
 
   // Free dynamically allocated memory
   free_parsed_data(processes, num_processes);
-  free(memory.page_table);
+  free_memory(&memory);
 
   return EXIT_SUCCESS;
 }
@@ -2,6 +2,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#include "buddy.h"
+#include "compact.h"
+#include "counters.h"
+#include "extent.h"
+#include "fit.h"
+#include "freetree.h"
+#include "pagesize.h"
+#include "shard.h"
+#include "snapshot.h"
+#include "timing.h"
 
 /**
  * Initializes the memory system.
@@ -17,99 +29,570 @@
  *     indicates free pages).
  */
 void init_memory(Memory *memory, int total_memory, int page_size) {
+  init_memory_policy(memory, total_memory, page_size, ALLOC_PAGING);
+}
+
+/**
+ * Initializes the memory system with a specific placement strategy.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure to initialize.
+ *   total_memory (int): Total size of the memory in KB.
+ *   page_size (int): Size of each page in KB.
+ *   policy (AllocPolicy): Placement strategy used by `allocate_memory`.
+ *
+ * Behavior:
+ *   - Sets up the page table as `init_memory` does.
+ *   - Creates the strategy's own bookkeeping when it needs any.
+ */
+void init_memory_policy(Memory *memory, int total_memory, int page_size,
+                        AllocPolicy policy) {
   memory->total_memory = total_memory;
   memory->page_size = page_size;
-  memory->total_pages = total_memory / page_size;
+  memory->page_shift = page_shift_of(page_size);
+  memory->total_pages = memory->page_shift >= 0
+                            ? total_memory >> memory->page_shift
+                            : total_memory / page_size;
   memory->page_table = malloc(memory->total_pages * sizeof(int));
+  memory->free_generation = 0;
 
   // Initialize all pages as free (-1 means free)
   for (int i = 0; i < memory->total_pages; i++) {
     memory->page_table[i] = -1;
   }
+
+  memory->free_tree = free_tree_create(memory->total_pages);
+  memory->policy = policy;
+  memory->buddy = NULL;
+  memory->fit = NULL;
+  memory->extents = NULL;
+  memory->compact = NULL;
+  memory->shards = NULL;
+  if (policy == ALLOC_BUDDY) {
+    buddy_init(memory);
+  } else if (policy == ALLOC_BEST_FIT || policy == ALLOC_NEXT_FIT) {
+    fit_init(memory);
+  }
 }
 
 /**
- * Allocates memory for a process in the memory system.
+ * Looks up a placement strategy by its command-line name.
  *
  * Args:
- *   memory (Memory*): Pointer to the `Memory` structure representing the memory
- * system. process_id (int): The ID of the process requesting memory allocation.
- *   num_pieces (int): Number of memory segments (pieces) required by the
- * process. piece_sizes (int*): Array containing the sizes of each memory
- * segment (in KB).
+ *   name (const char*): Strategy name ("paging", "buddy", "best-fit" or
+ * "next-fit").
+ *   policy (AllocPolicy*): Receives the matching strategy.
  *
  * Returns:
- *   int: 1 if memory allocation is successful, 0 if insufficient memory or
- * allocation fails.
+ *   int: 1 if the name is known, 0 otherwise.
+ */
+int parse_alloc_policy(const char *name, AllocPolicy *policy) {
+  if (strcmp(name, "paging") == 0) {
+    *policy = ALLOC_PAGING;
+  } else if (strcmp(name, "buddy") == 0) {
+    *policy = ALLOC_BUDDY;
+  } else if (strcmp(name, "best-fit") == 0) {
+    *policy = ALLOC_BEST_FIT;
+  } else if (strcmp(name, "next-fit") == 0) {
+    *policy = ALLOC_NEXT_FIT;
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Switches the memory system to a run-length extent table.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to a freshly initialized `Memory` structure.
+ *
+ * Returns:
+ *   int: 1 on success, 0 if the placement strategy needs a per-frame page
+ * table (only ALLOC_PAGING can run on extents), the compact page table is in
+ * use or the memory is split into shards.
  *
  * Behavior:
- *   1. Calculates the total number of pages needed for all requested memory
- * segments, rounding up each segment's size to the nearest page boundary.
- *   2. Counts the total number of free pages in the memory.
- *   3. If the total free pages are insufficient to meet the process's
- * requirements, the function immediately returns 0, indicating failure.
- *   4. If enough free pages are available:
- *      - Allocates memory segment-by-segment by marking free pages in the page
- * table.
- *      - If at any point a segment cannot be fully allocated, all previously
- * allocated pages for this process are rolled back (freed), and the function
- * returns 0.
- *   5. If all segments are successfully allocated, the function returns 1.
+ *   - Replaces `page_table` with sorted (start, length, owner) runs, so
+ * allocation, deallocation and the memory map cost O(runs) rather than
+ * O(total_pages).
+ */
+int use_extent_table(Memory *memory) {
+  if (memory->policy != ALLOC_PAGING || memory->compact || memory->shards) {
+    return 0;
+  }
+  if (!memory->extents) extent_init(memory);
+  return 1;
+}
+
+/**
+ * Switches the memory system to a compact page table.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to a freshly initialized `Memory` structure.
+ *
+ * Returns:
+ *   int: 1 on success, 0 if the extent table is in use.
+ *
+ * Behavior:
+ *   - Replaces `page_table` with a one-byte slot per frame, widened to two
+ * or four bytes only once that many processes are resident at the same time
+ * (see `CompactTable`). Scans of the page table then read a quarter to a
+ * half of the bytes. Works with every placement strategy, and for every
+ * shard of a split memory.
+ */
+int use_compact_table(Memory *memory) {
+  if (memory->extents) return 0;
+  if (memory->shards) {
+    for (int k = 0; k < memory->shards->count; k++) {
+      use_compact_table(&memory->shards->nodes[k]);
+    }
+    return 1;
+  }
+  if (!memory->compact) {
+    memory->compact = compact_create(memory->total_pages);
+    free(memory->page_table);
+    memory->page_table = NULL;
+  }
+  return 1;
+}
+
+/**
+ * Frees the page table and any strategy bookkeeping.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure to release.
+ */
+void free_memory(Memory *memory) {
+  shard_free(memory);
+  buddy_free(memory);
+  fit_free(memory);
+  extent_free(memory);
+  compact_destroy(memory->compact);
+  memory->compact = NULL;
+  free_tree_destroy(memory->free_tree);
+  memory->free_tree = NULL;
+  free(memory->page_table);
+  memory->page_table = NULL;
+}
+
+/**
+ * Gives a range of frames to a process or frees it.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure.
+ *   start (int): First frame of the range.
+ *   length (int): Number of frames in the range.
+ *   owner (int): Process ID taking the frames, or -1 to free them.
+ *
+ * Behavior:
+ *   - Writes the page table entries (if there is a per-frame page table) and
+ * updates the free-frame summary in O(log total_pages).
  *
  * Notes:
- *   - Memory allocation follows a "first fit" approach, scanning the page table
- *     sequentially for free pages.
- *   - Rollback ensures consistency in the event of partial allocation failure.
+ *   - Every change of a frame's owner must go through this function, or
+ * `memory_free_summary` goes stale. The extent table records ownership
+ * itself and calls this only to keep the summary current.
  */
-int allocate_memory(Memory *memory, int process_id, int num_pieces,
-                    int *piece_sizes) {
-  int total_pages_needed = 0;
-  for (int i = 0; i < num_pieces; i++) {
-    int pages_for_piece =
-        (piece_sizes[i] + memory->page_size - 1) / memory->page_size;
-    total_pages_needed += pages_for_piece;
+void set_frame_owner(Memory *memory, int start, int length, int owner) {
+  if (memory->shards) {
+    shard_set_frame_owner(memory->shards, start, length, owner);
+    return;
+  }
+  if (memory->page_table) {
+    for (int i = start; i < start + length; i++) {
+      memory->page_table[i] = owner;
+    }
+  } else if (memory->compact) {
+    compact_set(memory->compact, start, length, owner);
   }
+  free_tree_set(memory->free_tree, start, length, owner == -1);
+}
+
+// Process ID owning a frame (-1 if free), from whichever per-frame page table
+// is in use
+int frame_owner(const Memory *memory, int frame) {
+  if (memory->shards) return shard_frame_owner(memory->shards, frame);
+  if (memory->compact) return compact_owner(memory->compact, frame);
+  return memory->page_table[frame];
+}
 
-  // Count free pages
-  int free_pages = 0;
+/**
+ * Finds the next frame owned by a process, or the next free frame.
+ *
+ * Args:
+ *   memory (const Memory*): Pointer to the `Memory` structure, with a
+ * per-frame page table (not the extent table).
+ *   from (int): First frame to look at.
+ *   owner (int): Process ID to look for, or -1 for a free frame.
+ *
+ * Returns:
+ *   int: The first such frame at or after `from`, or `total_pages` if there
+ * is none.
+ *
+ * Notes:
+ *   - Free frames are found through the free-frame tree in O(log
+ * total_pages), skipping fully allocated ranges without reading them.
+ */
+int find_frame(const Memory *memory, int from, int owner) {
+  if (memory->shards) return shard_find_frame(memory->shards, from, owner);
+  if (owner == -1) return free_tree_find(memory->free_tree, from, 1);
+  if (memory->compact) return compact_find(memory->compact, from, owner);
+  int frame = from;
+  while (frame < memory->total_pages && memory->page_table[frame] != owner) {
+    frame++;
+  }
+  return frame;
+}
+
+/**
+ * Reports the free space of memory without scanning it.
+ *
+ * Args:
+ *   memory (const Memory*): Pointer to the `Memory` structure.
+ *
+ * Returns:
+ *   FreeSummary: Free frames, number of free runs and longest free run.
+ */
+FreeSummary memory_free_summary(const Memory *memory) {
+  if (memory->shards) return shard_free_summary(memory->shards);
+  const FreeTree *tree = memory->free_tree;
+  FreeSummary summary = {tree->free[1], tree->runs[1], tree->longest[1]};
+  return summary;
+}
+
+// Number of maximal runs of frames with a single owner
+static int count_owner_runs(Memory *memory) {
+  if (memory->extents) return memory->extents->count;
+  int runs = 0;
   for (int i = 0; i < memory->total_pages; i++) {
-    if (memory->page_table[i] == -1) {
-      free_pages++;
+    runs += i == 0 || frame_owner(memory, i) != frame_owner(memory, i - 1);
+  }
+  return runs;
+}
+
+// Writes a placement strategy's own bookkeeping
+static void save_strategy(Memory *memory, FILE *file) {
+  if (memory->policy == ALLOC_BUDDY) {
+    buddy_save(memory, file);
+  } else if (memory->policy == ALLOC_BEST_FIT ||
+             memory->policy == ALLOC_NEXT_FIT) {
+    fit_save(memory, file);
+  }
+}
+
+// Reads what `save_strategy` wrote
+static void restore_strategy(Memory *memory, FILE *file) {
+  if (memory->policy == ALLOC_BUDDY) {
+    buddy_restore(memory, file);
+  } else if (memory->policy == ALLOC_BEST_FIT ||
+             memory->policy == ALLOC_NEXT_FIT) {
+    fit_restore(memory, file);
+  }
+}
+
+/**
+ * Writes the memory system's state to a checkpoint.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure.
+ *   file (FILE*): Checkpoint being written.
+ *
+ * Behavior:
+ *   - Writes the memory geometry, placement strategy and sharding (checked
+ * on restore), the free generation, the frame owners as (length, owner) runs
+ * and finally the strategy's own bookkeeping, shard by shard.
+ */
+void memory_save(Memory *memory, FILE *file) {
+  snapshot_write_int(file, memory->total_memory);
+  snapshot_write_int(file, memory->page_size);
+  snapshot_write_int(file, memory->policy);
+  snapshot_write_int(file, memory->extents != NULL);
+  snapshot_write_int(file, memory->shards ? memory->shards->count : 0);
+  snapshot_write_int(file, memory->shards ? memory->shards->policy : 0);
+  snapshot_write_int(file, memory->free_generation);
+
+  snapshot_write_int(file, count_owner_runs(memory));
+  if (memory->extents) {
+    for (int i = 0; i < memory->extents->count; i++) {
+      snapshot_write_int(file, memory->extents->runs[i].length);
+      snapshot_write_int(file, memory->extents->runs[i].owner);
+    }
+  } else {
+    int start = 0;
+    for (int i = 1; i <= memory->total_pages; i++) {
+      if (i == memory->total_pages ||
+          frame_owner(memory, i) != frame_owner(memory, start)) {
+        snapshot_write_int(file, i - start);
+        snapshot_write_int(file, frame_owner(memory, start));
+        start = i;
+      }
     }
   }
 
-  // If not enough pages, fail immediately
-  if (free_pages < total_pages_needed) {
+  if (memory->shards) {
+    for (int k = 0; k < memory->shards->count; k++) {
+      save_strategy(&memory->shards->nodes[k], file);
+    }
+  } else {
+    save_strategy(memory, file);
+  }
+}
+
+/**
+ * Restores the memory system's state from a checkpoint.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to a freshly initialized `Memory` structure with
+ * the same size, page size and placement strategy (and extent table or
+ * shards, if used) as the checkpointed one.
+ *   file (FILE*): Checkpoint positioned at the memory state.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the checkpoint was taken
+ * with a different configuration or is malformed.
+ */
+void memory_restore(Memory *memory, FILE *file) {
+  if (snapshot_read_int(file) != memory->total_memory ||
+      snapshot_read_int(file) != memory->page_size ||
+      snapshot_read_int(file) != memory->policy ||
+      snapshot_read_int(file) != (memory->extents != NULL) ||
+      snapshot_read_int(file) !=
+          (memory->shards ? memory->shards->count : 0) ||
+      snapshot_read_int(file) !=
+          (memory->shards ? (int)memory->shards->policy : 0)) {
+    snapshot_fail("memory size, page size or placement differs");
+  }
+  memory->free_generation = snapshot_read_int(file);
+
+  int count = snapshot_read_int(file);
+  if (count < 0 || count > memory->total_pages) {
+    snapshot_fail("malformed frame owners");
+  }
+  Extent *runs = malloc((count > 0 ? count : 1) * sizeof(Extent));
+  if (!runs) {
+    perror("Error allocating memory for checkpoint runs");
+    exit(EXIT_FAILURE);
+  }
+  int frame = 0;
+  for (int i = 0; i < count; i++) {
+    runs[i].start = frame;
+    runs[i].length = snapshot_read_int(file);
+    runs[i].owner = snapshot_read_int(file);
+    if (runs[i].length <= 0 || frame + runs[i].length > memory->total_pages) {
+      snapshot_fail("frame owners do not fit memory");
+    }
+    frame += runs[i].length;
+  }
+  if (frame != memory->total_pages) {
+    snapshot_fail("frame owners do not cover memory");
+  }
+
+  if (memory->extents) {
+    extent_restore(memory, runs, count);
+  } else {
+    for (int i = 0; i < count; i++) {
+      set_frame_owner(memory, runs[i].start, runs[i].length, runs[i].owner);
+    }
+  }
+  free(runs);
+
+  if (memory->shards) {
+    for (int k = 0; k < memory->shards->count; k++) {
+      restore_strategy(&memory->shards->nodes[k], file);
+    }
+  } else {
+    restore_strategy(memory, file);
+  }
+}
+
+// First-fit paging over the per-frame (or compact) page table, searching
+// from `*frame`, below which every frame must be in use. Leaves `*frame`
+// where the next process's search can start.
+static int allocate_pages_from(Memory *memory, int process_id, int num_pieces,
+                               const int *piece_pages, int *next_frame) {
+  // Free pages are counted as frames change owner
+  int free_pages = memory_free_summary(memory).free_pages;
+
+  // Pieces with a negative size take nothing, so they cannot make room for
+  // the others. Checking the pages the pieces actually take is exact, and a
+  // request that cannot be placed fails before any frame is written.
+  int demand = 0;
+  for (int i = 0; i < num_pieces; i++) {
+    if (piece_pages[i] > 0) demand += piece_pages[i];
+  }
+  if (free_pages < demand) {
     return 0;  // Not enough memory, must wait
   }
 
-  // Enough memory is available, proceed to allocate
+  // Enough memory is available, proceed to allocate. Each piece takes the
+  // lowest free frames left, so every frame below `frame` is in use and the
+  // next piece carries on from there. Whole free runs are claimed at once.
+  // The free frames at or after `frame` always cover what is left.
+  int frame = *next_frame;
   for (int i = 0; i < num_pieces; i++) {
-    int pages_needed =
-        (piece_sizes[i] + memory->page_size - 1) / memory->page_size;
     int pages_allocated = 0;
-
-    for (int j = 0; j < memory->total_pages && pages_allocated < pages_needed;
-         j++) {
-      if (memory->page_table[j] == -1) {
-        memory->page_table[j] = process_id;
-        pages_allocated++;
+    while (pages_allocated < piece_pages[i] &&
+           (frame = find_frame(memory, frame, -1)) < memory->total_pages) {
+      int run = free_tree_find(memory->free_tree, frame, 0) - frame;
+      if (run > piece_pages[i] - pages_allocated) {
+        run = piece_pages[i] - pages_allocated;
       }
+      set_frame_owner(memory, frame, run, process_id);
+      pages_allocated += run;
+      frame += run;
+      COUNTER_ADD(alloc_pages_scanned, 1);
     }
+  }
 
-    // Should always succeed since we checked beforehand. If not:
-    if (pages_allocated < pages_needed) {
-      // Rollback any allocated pages
-      for (int k = 0; k < memory->total_pages; k++) {
-        if (memory->page_table[k] == process_id) {
-          memory->page_table[k] = -1;
-        }
-      }
-      return 0;  // Fail allocation
+  *next_frame = frame;
+  return 1;  // Allocation successful
+}
+
+// First-fit paging searching from frame 0
+static int allocate_pages(Memory *memory, int process_id, int num_pieces,
+                          const int *piece_pages) {
+  int frame = 0;
+  return allocate_pages_from(memory, process_id, num_pieces, piece_pages,
+                             &frame);
+}
+
+/**
+ * Allocates memory for a process in the memory system.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure representing the memory
+ * system. process_id (int): The ID of the process requesting memory allocation.
+ *   num_pieces (int): Number of memory segments (pieces) required by the
+ * process. piece_pages (const int*): Array containing the number of pages
+ * needed by each memory segment. total_pages_needed (int): Sum of
+ * `piece_pages`.
+ *
+ * Returns:
+ *   int: 1 if memory allocation is successful, 0 if insufficient memory or
+ * allocation fails.
+ *
+ * Behavior:
+ *   1. Looks up the total number of free pages in the memory (kept current
+ * by `set_frame_owner`, so no scan is needed).
+ *   2. If the total free pages are insufficient to meet the process's
+ * requirements, the function immediately returns 0, indicating failure.
+ *   3. If enough free pages are available, allocates memory
+ * segment-by-segment by marking free pages in the page table, and returns 1.
+ *   - All or nothing: a process that cannot be placed leaves memory as it
+ * was. Paging fails before writing or reading any frame, and other
+ * strategies write only frames the failed call itself claimed.
+ *
+ * Notes:
+ *   - With ALLOC_PAGING, memory allocation follows a "first fit" approach,
+ *     taking the lowest-numbered free pages. The free-frame tree finds each
+ *     run of free pages in O(log total_pages) instead of scanning the page
+ *     table from frame 0.
+ *   - With ALLOC_BUDDY, each piece is placed in its own contiguous block by
+ *     `buddy_allocate`.
+ *   - With ALLOC_BEST_FIT or ALLOC_NEXT_FIT, each piece is placed in its own
+ *     contiguous free extent by `fit_allocate`.
+ *   - With `shards`, the shard placement policy picks the shards and each
+ *     places its share with the strategy above (see `shard_allocate`).
+ *   - Page counts are precomputed by `compute_page_demand`, so no division by
+ *     the page size happens here.
+ *   - Paging and extent tables check the exact free page count before
+ * writing anything, after which placement cannot fail. Buddy and free-extent
+ * placement undo a partial failure from the list of blocks or pieces they
+ * took, and shards release only the shards they wrote to.
+ */
+int allocate_memory(Memory *memory, int process_id, int num_pieces,
+                    const int *piece_pages, int total_pages_needed) {
+  TIMER_START(start);
+  int allocated;
+  if (memory->shards) {
+    allocated = shard_allocate(memory->shards, process_id, num_pieces,
+                               piece_pages, total_pages_needed);
+  } else {
+    allocated = place_process(memory, process_id, num_pieces, piece_pages,
+                              total_pages_needed);
+  }
+
+  COUNTER_ADD(alloc_calls, 1);
+  COUNTER_ADD(alloc_successes, allocated);
+  COUNTER_ADD(alloc_failures, !allocated);
+  TIMER_STOP(TIMER_ALLOCATE, start);
+  return allocated;
+}
+
+// Places a process with the memory's own strategy, as `allocate_memory` does
+// but without counting or timing the call (each shard of a split memory is
+// placed through this)
+int place_process(Memory *memory, int process_id, int num_pieces,
+                  const int *piece_pages, int total_pages_needed) {
+  if (memory->policy == ALLOC_BUDDY) {
+    return buddy_allocate(memory, process_id, num_pieces, piece_pages);
+  } else if (memory->policy == ALLOC_BEST_FIT ||
+             memory->policy == ALLOC_NEXT_FIT) {
+    return fit_allocate(memory, process_id, num_pieces, piece_pages);
+  } else if (memory->extents) {
+    return extent_allocate(memory, process_id, total_pages_needed);
+  }
+  return allocate_pages(memory, process_id, num_pieces, piece_pages);
+}
+
+/**
+ * Allocates memory for a run of processes in first-come, first-served order.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure.
+ *   requests (const AllocRequest*): Processes to place, in order.
+ *   count (int): Number of requests.
+ *
+ * Returns:
+ *   int: Number of processes placed. They are always the first ones, since
+ * placement stops at the first process that does not fit.
+ *
+ * Behavior:
+ *   - Places exactly what the same `allocate_memory` calls, one per request
+ * until one fails, would have placed.
+ *   - With ALLOC_PAGING on a page table, every frame below the last one a
+ * process took is in use, so the whole run is placed in a single forward
+ * sweep of the free frames instead of a fresh search from frame 0 for each
+ * process.
+ *   - Other strategies, extent tables and shards place the processes one
+ * after another.
+ *
+ * Notes:
+ *   - Counted as one `allocate_memory` call per process tried.
+ */
+int allocate_memory_batch(Memory *memory, const AllocRequest *requests,
+                          int count) {
+  TIMER_START(start);
+  int sweep = memory->policy == ALLOC_PAGING && !memory->extents &&
+              !memory->shards;
+  int frame = 0;
+  int placed = 0;
+  while (placed < count) {
+    const AllocRequest *request = &requests[placed];
+    int allocated;
+    if (sweep) {
+      allocated = allocate_pages_from(memory, request->process_id,
+                                      request->num_pieces,
+                                      request->piece_pages, &frame);
+    } else if (memory->shards) {
+      allocated = shard_allocate(memory->shards, request->process_id,
+                                 request->num_pieces, request->piece_pages,
+                                 request->total_pages_needed);
+    } else {
+      allocated = place_process(memory, request->process_id,
+                                request->num_pieces, request->piece_pages,
+                                request->total_pages_needed);
     }
+    if (!allocated) break;
+    placed++;
   }
 
-  return 1;  // Allocation successful
+  COUNTER_ADD(alloc_calls, placed + (placed < count));
+  COUNTER_ADD(alloc_successes, placed);
+  COUNTER_ADD(alloc_failures, placed < count);
+  TIMER_STOP(TIMER_ALLOCATE, start);
+  return placed;
 }
 
 /**
@@ -126,73 +609,185 @@ int allocate_memory(Memory *memory, int process_id, int num_pieces,
  * (matching `process_id`).
  *   - Marks those pages as free by setting their entries in the page table to
  * -1.
+ *   - Bumps `free_generation` if any page was freed, so callers can tell
+ * whether a previously failed allocation is worth retrying.
  *
  * Notes:
  *   - This function assumes that `process_id` corresponds to a valid process.
+ *   - With `shards`, every shard frees its own frames, at the same time when
+ * the shards have worker threads (see `shard_deallocate`).
  */
 void deallocate_memory(Memory *memory, int process_id) {
-  // Loop through all pages in the memory system
-  for (int i = 0; i < memory->total_pages; i++) {
-    // If the page belongs to the specified process, mark it as free
-    if (memory->page_table[i] == process_id) {
-      memory->page_table[i] = -1;  // Mark page as free by setting it to -1
-    }
+  TIMER_START(start);
+  int pages_freed;
+  if (memory->shards) {
+    pages_freed = shard_deallocate(memory->shards, process_id);
+  } else {
+    pages_freed = release_process(memory, process_id);
+  }
+
+  COUNTER_ADD(dealloc_calls, 1);
+  TIMER_STOP(TIMER_DEALLOCATE, start);
+
+  if (pages_freed > 0) {
+    memory->free_generation++;
   }
 }
 
+// Frees a process's frames with the memory's own strategy and returns how
+// many were freed, as `deallocate_memory` does but without counting the call
+// or bumping `free_generation` (each shard of a split memory is freed
+// through this)
+int release_process(Memory *memory, int process_id) {
+  if (memory->policy == ALLOC_BUDDY) {
+    return buddy_deallocate(memory, process_id);
+  } else if (memory->policy == ALLOC_BEST_FIT ||
+             memory->policy == ALLOC_NEXT_FIT) {
+    return fit_deallocate(memory, process_id);
+  } else if (memory->extents) {
+    return extent_deallocate(memory, process_id);
+  }
+
+  // Free each run of pages belonging to the specified process at once, so
+  // the free-frame summary is updated once per run rather than per page
+  int pages_freed = 0;
+  int frame = 0, length;
+  while (find_owned_run(memory, process_id, &frame, &length)) {
+    set_frame_owner(memory, frame, length, -1);
+    pages_freed += length;
+    frame += length;
+  }
+  COUNTER_ADD(dealloc_pages_scanned, memory->total_pages);
+  return pages_freed;
+}
+
 /**
- * Prints the current memory map, showing free frames and allocated pages.
+ * Finds the next run of consecutive frames owned by a process.
  *
  * Args:
- *   memory (Memory*): Pointer to the `Memory` structure containing the memory
- * state. page_size (int): Size of each page in the memory system (in KB).
+ *   memory (Memory*): Pointer to the `Memory` structure.
+ *   process_id (int): ID of the process whose frames are searched.
+ *   frame (int*): Frame to search from; set to the start of the run found.
+ *   length (int*): Set to the number of frames in the run found.
  *
- * Behavior:
- *   - Iterates through the memory's page table.
- *   - Prints ranges of free frames as contiguous blocks.
- *   - Prints allocated frames with process ID and corresponding page number.
- *   - Tracks page numbers for each process to display correct page numbering.
+ * Returns:
+ *   int: 1 if a run was found, 0 if the process owns no frame at or after
+ * `*frame`.
  *
  * Notes:
- *   - The function assumes memory is divided into fixed-size pages.
- *   - Free frames are identified with a `-1` in the page table.
+ *   - Visits every run of a process when called from frame 0 and resumed at
+ * `*frame + *length` after each run.
  */
-void print_memory_map(Memory *memory, int page_size) {
-  printf("       Memory Map:\n");
+int find_owned_run(Memory *memory, int process_id, int *frame, int *length) {
+  if (memory->extents) {
+    return extent_find_run(memory, process_id, frame, length);
+  }
+
+  int start = find_frame(memory, *frame, process_id);
+  if (start >= memory->total_pages) return 0;
+
+  int end = start + 1;
+  while (end < memory->total_pages && frame_owner(memory, end) == process_id) {
+    end++;
+  }
+  *frame = start;
+  *length = end - start;
+  return 1;
+}
+
+// Prints the memory map by walking the per-frame page table. Frame i starts
+// at address (i * scale) << shift; the two callers below pass constants for
+// one of them, so each gets its own loop with the other operation folded away.
+static inline __attribute__((always_inline)) void frame_map_kernel(
+    Memory *memory, int scale, int shift, FILE *out) {
+  fprintf(out, "       Memory Map:\n");
 
   int start = -1;  // Marks the start address of a free range
-  int page_number[1000] = {
-      0};  // Tracks the page numbers for processes (up to 1000 process IDs)
+
+  // Tracks the page numbers for processes, sized by the largest resident ID
+  int max_process_id = 0;
+  for (int i = 0; i < memory->total_pages; i++) {
+    if (frame_owner(memory, i) > max_process_id) {
+      max_process_id = frame_owner(memory, i);
+    }
+  }
+  int *page_number = calloc(max_process_id + 1, sizeof(int));
+  if (!page_number) {
+    perror("Error allocating memory for page numbers");
+    exit(EXIT_FAILURE);
+  }
 
   // Iterate through all pages in the memory
   for (int i = 0; i < memory->total_pages; i++) {
-    int start_address = i * page_size;  // Start address of the current page
+    int start_address = (i * scale) << shift;  // Start of the current page
     int end_address =
-        (i + 1) * page_size - 1;  // End address of the current page
+        (((i + 1) * scale) << shift) - 1;  // End address of the current page
 
     // Check if the current page is free
-    if (memory->page_table[i] == -1) {
+    int process_id = frame_owner(memory, i);
+    if (process_id == -1) {
       if (start == -1) start = start_address;  // Mark the start of a free range
     } else {
       // If a free range was being tracked, print it
       if (start != -1) {
-        printf("                  %d-%d: Free frame(s)\n", start,
-               start_address - 1);
+        fprintf(out, "                  %d-%d: Free frame(s)\n", start,
+                start_address - 1);
         start = -1;  // Reset the start of the free range
       }
 
       // Print allocated page details
-      int process_id = memory->page_table[i];
       page_number[process_id]++;  // Increment the page count for the process
 
-      printf("                  %d-%d: Process %d, Page %d\n", start_address,
-             end_address, process_id, page_number[process_id]);
+      fprintf(out, "                  %d-%d: Process %d, Page %d\n",
+              start_address, end_address, process_id, page_number[process_id]);
     }
   }
 
   // If we have an ongoing free range at the end of the memory, print it
   if (start != -1) {
-    printf("                  %d-%d: Free frame(s)\n", start,
-           memory->total_pages * page_size - 1);
+    fprintf(out, "                  %d-%d: Free frame(s)\n", start,
+            ((memory->total_pages * scale) << shift) - 1);
+  }
+
+  free(page_number);
+}
+
+// Frame map for any page size, multiplying by it
+static void print_frame_map_scaled(Memory *memory, int page_size, FILE *out) {
+  frame_map_kernel(memory, page_size, 0, out);
+}
+
+// Frame map for a power-of-two page size, shifting by its logarithm
+static void print_frame_map_shifted(Memory *memory, int shift, FILE *out) {
+  frame_map_kernel(memory, 1, shift, out);
+}
+
+/**
+ * Prints the current memory map, showing free frames and allocated pages.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to the `Memory` structure containing the memory
+ * state. page_size (int): Size of each page in the memory system (in KB).
+ *   out (FILE*): Stream the map is written to.
+ *
+ * Behavior:
+ *   - Iterates through the memory's page table.
+ *   - Prints ranges of free frames as contiguous blocks.
+ *   - Prints allocated frames with process ID and corresponding page number.
+ *   - Tracks page numbers for each process to display correct page numbering.
+ *
+ * Notes:
+ *   - The function assumes memory is divided into fixed-size pages.
+ *   - Free frames are identified with a `-1` in the page table.
+ */
+void print_memory_map(Memory *memory, int page_size, FILE *out) {
+  TIMER_START(start);
+  if (memory->extents) {
+    extent_print_map(memory, page_size, out);
+  } else if (page_size == memory->page_size && memory->page_shift >= 0) {
+    print_frame_map_shifted(memory, memory->page_shift, out);
+  } else {
+    print_frame_map_scaled(memory, page_size, out);
   }
+  TIMER_STOP(TIMER_MEMORY_MAP, start);
 }
@@ -1,19 +1,80 @@
 #ifndef MEMORY_H
 #define MEMORY_H
 
-typedef struct {
+#include <stdio.h>
+
+// Placement strategies supported by the memory system
+typedef enum {
+  ALLOC_PAGING,    // Pages of a process scattered over the first free frames
+  ALLOC_BUDDY,     // Each piece in one contiguous buddy-system block
+  ALLOC_BEST_FIT,  // Each piece in the smallest free extent that holds it
+  ALLOC_NEXT_FIT,  // Each piece in the next free extent that holds it,
+                   // resuming after the previous placement
+} AllocPolicy;
+
+typedef struct Memory {
   int total_memory;  // Total size of memory in KB
   int page_size;     // Size of each page or chunk in KB
+  int page_shift;    // log2(page_size) when it is a power of two, else -1
   int total_pages;   // Total number of pages in memory
   int *page_table;   // Array representing the allocation of pages (-1 for free,
-                     // process ID for allocated)
+                     // process ID for allocated). NULL when `extents`,
+                     // `compact` or `shards` is used.
+  unsigned long free_generation;  // Incremented whenever pages are freed
+  AllocPolicy policy;             // Placement strategy in use
+  struct Buddy *buddy;            // Buddy allocator state (NULL unless
+                                  // `policy` is ALLOC_BUDDY)
+  struct Fit *fit;                // Free-extent allocator state (NULL unless
+                                  // `policy` is ALLOC_BEST_FIT/NEXT_FIT)
+  struct ExtentTable *extents;    // Run-length ownership replacing
+                                  // `page_table` (NULL unless enabled)
+  struct CompactTable *compact;   // Narrow per-frame slots replacing
+                                  // `page_table` (NULL unless enabled)
+  struct FreeTree *free_tree;     // Free-frame summary, updated by every
+                                  // `set_frame_owner` call
+  struct ShardSet *shards;        // NUMA-style shards holding the frames
+                                  // instead, each with its own page table,
+                                  // tree and allocator (NULL unless split)
 } Memory;
 
+// Free space of a memory system, maintained as frames change owner
+typedef struct {
+  int free_pages;        // Number of free frames
+  int free_runs;         // Number of maximal runs of free frames
+  int largest_free_run;  // Length of the longest run of free frames
+} FreeSummary;
+
+// One process's memory demand, as passed to `allocate_memory`
+typedef struct {
+  int process_id;          // Process to place
+  int num_pieces;          // Number of memory pieces
+  const int *piece_pages;  // Pages needed by each piece
+  int total_pages_needed;  // Sum of `piece_pages`
+} AllocRequest;
+
 // Function prototypes
 void init_memory(Memory *memory, int total_memory, int page_size);
+void init_memory_policy(Memory *memory, int total_memory, int page_size,
+                        AllocPolicy policy);
+int parse_alloc_policy(const char *name, AllocPolicy *policy);
+int use_extent_table(Memory *memory);
+int use_compact_table(Memory *memory);
+void free_memory(Memory *memory);
+void set_frame_owner(Memory *memory, int start, int length, int owner);
+int frame_owner(const Memory *memory, int frame);
+int find_frame(const Memory *memory, int from, int owner);
+FreeSummary memory_free_summary(const Memory *memory);
+void memory_save(Memory *memory, FILE *file);
+void memory_restore(Memory *memory, FILE *file);
 int allocate_memory(Memory *memory, int process_id, int num_pieces,
-                    int *piece_sizes);
+                    const int *piece_pages, int total_pages_needed);
+int allocate_memory_batch(Memory *memory, const AllocRequest *requests,
+                          int count);
+int place_process(Memory *memory, int process_id, int num_pieces,
+                  const int *piece_pages, int total_pages_needed);
 void deallocate_memory(Memory *memory, int process_id);
-void print_memory_map(Memory *memory, int page_size);
+int release_process(Memory *memory, int process_id);
+int find_owned_run(Memory *memory, int process_id, int *frame, int *length);
+void print_memory_map(Memory *memory, int page_size, FILE *out);
 
 #endif
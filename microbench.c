@@ -0,0 +1,233 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "extent.h"
+#include "memory.h"
+#include "shard.h"
+
+// A backend under test: a placement strategy plus page table representation
+typedef struct {
+  const char *name;
+  AllocPolicy policy;
+  int extents;
+  int compact;
+  int shards;  // Local-first shards to split memory into (0 for none)
+} Backend;
+
+static const Backend kBackends[] = {
+    {"paging", ALLOC_PAGING, 0, 0, 0},
+    {"paging-extents", ALLOC_PAGING, 1, 0, 0},
+    {"paging-compact", ALLOC_PAGING, 0, 1, 0},
+    {"paging-4-shards", ALLOC_PAGING, 0, 0, 4},
+    {"buddy", ALLOC_BUDDY, 0, 0, 0},
+    {"best-fit", ALLOC_BEST_FIT, 0, 0, 0},
+    {"next-fit", ALLOC_NEXT_FIT, 0, 0, 0},
+};
+static const int kGrains[] = {1, 8, 64};            // Filler size (frames)
+static const int kOccupancy[] = {25, 50, 75, 90};   // Percent of frames used
+static const int kPieces[] = {1, 4, 16};            // Pieces per request
+#define COUNT(array) ((int)(sizeof(array) / sizeof((array)[0])))
+
+#define REQUEST_PAGES 16  // Pages per measured request
+#define BATCH 16          // Requests allocated before they are freed again
+#define FIRST_PID 1       // Filler processes use IDs from here up
+
+// Monotonic wall-clock time in nanoseconds
+static double now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Counts free runs and the longest one, whichever table the memory uses
+static int count_free_runs(Memory *memory, int *largest) {
+  int runs = 0;
+  *largest = 0;
+  if (memory->extents) {
+    ExtentTable *table = memory->extents;
+    for (int i = 0; i < table->count; i++) {
+      if (table->runs[i].owner != -1) continue;
+      runs++;
+      if (table->runs[i].length > *largest) *largest = table->runs[i].length;
+    }
+    return runs;
+  }
+
+  int length = 0;
+  for (int i = 0; i <= memory->total_pages; i++) {
+    if (i < memory->total_pages && frame_owner(memory, i) == -1) {
+      length++;
+    } else if (length > 0) {
+      runs++;
+      if (length > *largest) *largest = length;
+      length = 0;
+    }
+  }
+  return runs;
+}
+
+// Fills memory with `grain`-frame processes, then frees a random subset of
+// them until roughly `occupancy` percent of frames remain in use. Returns the
+// first process ID that is free for measured requests.
+static int prepare(Memory *memory, int grain, int occupancy,
+                   unsigned long long *state) {
+  int pid = FIRST_PID;
+  while (allocate_memory(memory, pid, 1, &grain, grain)) pid++;
+  int fillers = pid - FIRST_PID;
+
+  // Shuffle the filler IDs and free them until the target is reached
+  int *order = malloc((fillers > 0 ? fillers : 1) * sizeof(int));
+  if (!order) {
+    perror("Error allocating memory for fillers");
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < fillers; i++) order[i] = FIRST_PID + i;
+  for (int i = fillers - 1; i > 0; i--) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    int j = (int)(*state % (unsigned long long)(i + 1));
+    int swap = order[i];
+    order[i] = order[j];
+    order[j] = swap;
+  }
+
+  long long used = (long long)fillers * grain;
+  long long target = (long long)memory->total_pages * occupancy / 100;
+  for (int i = 0; i < fillers && used - grain >= target; i++) {
+    deallocate_memory(memory, order[i]);
+    used -= grain;
+  }
+
+  free(order);
+  return pid;
+}
+
+/**
+ * Measures allocate_memory/deallocate_memory throughput over prepared memory
+ * states.
+ *
+ * Behavior:
+ *   - For every backend, filler size (fragmentation) and occupancy level,
+ * fills a fresh memory with fillers and frees a random subset of them.
+ *   - For every piece-count mix, repeatedly allocates a batch of requests of
+ * REQUEST_PAGES pages split into that many pieces, then frees the batch, and
+ * reports the mean cost per call along with the number of failed
+ * allocations.
+ *   - Prints one CSV row (default) or one JSON object per configuration.
+ */
+int main(int argc, char *argv[]) {
+  int frames = 16384;
+  int iterations = 20;
+  int json = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--frames=", 9) == 0) {
+      frames = atoi(argv[i] + 9);
+    } else if (strncmp(argv[i], "--iterations=", 13) == 0) {
+      iterations = atoi(argv[i] + 13);
+    } else if (strcmp(argv[i], "--format=json") == 0) {
+      json = 1;
+    } else if (strcmp(argv[i], "--format=csv") == 0) {
+      json = 0;
+    } else {
+      fprintf(stderr,
+              "Usage: %s [--frames=N] [--iterations=N] "
+              "[--format=csv|json]\n",
+              argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (frames <= 0 || iterations <= 0) {
+    fprintf(stderr, "Error: --frames and --iterations must be positive.\n");
+    return EXIT_FAILURE;
+  }
+
+  if (json) {
+    printf("[\n");
+  } else {
+    printf(
+        "backend,frames,grain,occupancy,free_runs,largest_free_run,pieces,"
+        "alloc_ns,dealloc_ns,alloc_failures\n");
+  }
+
+  int first_row = 1;
+  for (int b = 0; b < COUNT(kBackends); b++) {
+    for (int g = 0; g < COUNT(kGrains); g++) {
+      for (int o = 0; o < COUNT(kOccupancy); o++) {
+        const Backend *backend = &kBackends[b];
+        unsigned long long state = 88172645463325252ULL;
+
+        // Page size 1 so that pages and KB coincide
+        Memory memory;
+        init_memory_policy(&memory, frames, 1, backend->policy);
+        if (backend->extents) use_extent_table(&memory);
+        if (backend->compact) use_compact_table(&memory);
+        if (backend->shards &&
+            !shard_split(&memory, backend->shards, SHARD_LOCAL)) {
+          free_memory(&memory);
+          continue;  // Frames do not divide into the shards
+        }
+        int pid = prepare(&memory, kGrains[g], kOccupancy[o], &state);
+
+        int largest;
+        int free_runs = count_free_runs(&memory, &largest);
+
+        for (int p = 0; p < COUNT(kPieces); p++) {
+          int pieces = kPieces[p];
+          int piece_pages[REQUEST_PAGES];
+          for (int i = 0; i < pieces; i++) {
+            piece_pages[i] = REQUEST_PAGES / pieces;
+          }
+
+          double alloc_ns = 0, dealloc_ns = 0;
+          int failures = 0;
+          for (int it = 0; it < iterations; it++) {
+            double t0 = now_ns();
+            for (int k = 0; k < BATCH; k++) {
+              if (!allocate_memory(&memory, pid + k, pieces, piece_pages,
+                                   REQUEST_PAGES)) {
+                failures++;
+              }
+            }
+            double t1 = now_ns();
+            for (int k = 0; k < BATCH; k++) {
+              deallocate_memory(&memory, pid + k);
+            }
+            double t2 = now_ns();
+            alloc_ns += t1 - t0;
+            dealloc_ns += t2 - t1;
+          }
+
+          double calls = (double)iterations * BATCH;
+          if (json) {
+            printf(
+                "%s  {\"backend\": \"%s\", \"frames\": %d, \"grain\": %d, "
+                "\"occupancy\": %d, \"free_runs\": %d, "
+                "\"largest_free_run\": %d, \"pieces\": %d, "
+                "\"alloc_ns\": %.1f, \"dealloc_ns\": %.1f, "
+                "\"alloc_failures\": %d}",
+                first_row ? "" : ",\n", backend->name, frames, kGrains[g],
+                kOccupancy[o], free_runs, largest, pieces, alloc_ns / calls,
+                dealloc_ns / calls, failures);
+          } else {
+            printf("%s,%d,%d,%d,%d,%d,%d,%.1f,%.1f,%d\n", backend->name,
+                   frames, kGrains[g], kOccupancy[o], free_runs, largest,
+                   pieces, alloc_ns / calls, dealloc_ns / calls, failures);
+          }
+          first_row = 0;
+          fflush(stdout);
+        }
+
+        free_memory(&memory);
+      }
+    }
+  }
+
+  if (json) printf("\n]\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,11 @@
+#ifndef PAGESIZE_H
+#define PAGESIZE_H
+
+// Returns log2(page_size) if the page size is a power of two, or -1, so page
+// math can use shifts and masks instead of division and multiplication
+static inline int page_shift_of(int page_size) {
+  if (page_size <= 0 || (page_size & (page_size - 1)) != 0) return -1;
+  return __builtin_ctz(page_size);
+}
+
+#endif
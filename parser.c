@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "pagesize.h"
+
 /**
  * Parses the input file to extract process details.
  *
@@ -73,12 +75,75 @@ Process *parse_input_file(const char *filename, int *num_processes) {
     for (int j = 0; j < processes[i].memory_pieces; j++) {
       fscanf(file, "%d", &processes[i].piece_sizes[j]);
     }
+
+    // Page demand depends on the page size and is filled in later
+    processes[i].piece_pages = NULL;
+    processes[i].pages_needed = 0;
+    processes[i].demand_page_size = 0;
   }
 
   fclose(file);
   return processes;
 }
 
+/**
+ * Computes and caches the page demand of each process for a page size.
+ *
+ * Args:
+ *   processes (Process*): Pointer to the array of `Process` structures.
+ *   num_processes (int): Number of processes in the array.
+ *   page_size (int): Size of each page in KB.
+ *
+ * Behavior:
+ *   - Rounds each memory piece up to the nearest page boundary and stores the
+ * result in `piece_pages`, along with the total in `pages_needed`.
+ *   - Skips processes whose demand was already computed for `page_size`, so
+ * the divisions are done once per (process, page size) rather than on every
+ * allocation attempt.
+ *   - Uses a shift for power-of-two page sizes instead of dividing, except
+ * for negative sizes, which division rounds differently.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+void compute_page_demand(Process *processes, int num_processes,
+                         int page_size) {
+  // Power-of-two page sizes round up with a mask and a shift instead
+  int shift = page_shift_of(page_size);
+  int mask = page_size - 1;
+
+  for (int i = 0; i < num_processes; i++) {
+    Process *process = &processes[i];
+    if (process->demand_page_size == page_size) continue;
+
+    if (!process->piece_pages) {
+      process->piece_pages = malloc(process->memory_pieces * sizeof(int));
+      if (!process->piece_pages && process->memory_pieces > 0) {
+        perror("Error allocating memory for piece pages");
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    process->pages_needed = 0;
+    if (shift >= 0) {
+      for (int j = 0; j < process->memory_pieces; j++) {
+        // Shifting rounds down, so negative sizes keep truncating division
+        int size = process->piece_sizes[j];
+        process->piece_pages[j] =
+            size >= 0 ? (size + mask) >> shift : (size + mask) / page_size;
+        process->pages_needed += process->piece_pages[j];
+      }
+    } else {
+      for (int j = 0; j < process->memory_pieces; j++) {
+        process->piece_pages[j] =
+            (process->piece_sizes[j] + page_size - 1) / page_size;
+        process->pages_needed += process->piece_pages[j];
+      }
+    }
+    process->demand_page_size = page_size;
+  }
+}
+
 /**
  * Frees the memory allocated for the parsed process data.
  *
@@ -88,7 +153,7 @@ Process *parse_input_file(const char *filename, int *num_processes) {
  *
  * Behavior:
  *   - Frees the dynamically allocated memory for:
- *     - Each process's `piece_sizes` array.
+ *     - Each process's `piece_sizes` and `piece_pages` arrays.
  *     - The array of `Process` structures itself.
  *
  * Notes:
@@ -98,6 +163,7 @@ Process *parse_input_file(const char *filename, int *num_processes) {
 void free_parsed_data(Process *processes, int num_processes) {
   for (int i = 0; i < num_processes; i++) {
     free(processes[i].piece_sizes);
+    free(processes[i].piece_pages);
   }
   free(processes);
 }
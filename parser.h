@@ -9,10 +9,15 @@ typedef struct {
   int *piece_sizes;   // Array of memory segment sizes
   int start_time;  // The time when the process is first moved to memory (-1 if
                    // not started yet)
+  int *piece_pages;      // Pages needed by each memory segment
+  int pages_needed;      // Total pages needed across all segments
+  int demand_page_size;  // Page size `piece_pages` was computed for (0 if
+                         // not computed yet)
 } Process;
 
 // Function prototypes
 Process *parse_input_file(const char *filename, int *num_processes);
+void compute_page_demand(Process *processes, int num_processes, int page_size);
 void free_parsed_data(Process *processes, int num_processes);
 
 #endif
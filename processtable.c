@@ -0,0 +1,181 @@
+#include "processtable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Allocates one column of `count` ints
+static int *new_column(int count) {
+  int *column = malloc((count > 0 ? count : 1) * sizeof(int));
+  if (!column) {
+    perror("Error allocating memory for process table");
+    exit(EXIT_FAILURE);
+  }
+  return column;
+}
+
+// Resizes a column to `capacity` ints, keeping its contents
+static int *grow_column(int *column, int capacity) {
+  column = realloc(column, capacity * sizeof(int));
+  if (!column) {
+    perror("Error allocating memory for process table");
+    exit(EXIT_FAILURE);
+  }
+  return column;
+}
+
+/**
+ * Builds a process table from parsed processes.
+ *
+ * Args:
+ *   table (ProcessTable*): Receives the table; release it with
+ * `process_table_free`.
+ *   processes (const Process*): Parsed processes, with page demand computed
+ * by `compute_page_demand`.
+ *   num_processes (int): Number of processes.
+ *
+ * Behavior:
+ *   - Copies each field the simulator uses into its own column and every
+ * process's piece demand into one shared array, and marks every process as
+ * not started. `processes` is not referenced afterwards.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+void process_table_build(ProcessTable *table, const Process *processes,
+                         int num_processes) {
+  int n = num_processes;
+  table->count = n;
+  table->capacity = n;
+  table->id = new_column(n);
+  table->arrival = new_column(n);
+  table->lifetime = new_column(n);
+  table->start = new_column(n);
+  table->pages_needed = new_column(n);
+  table->piece_offset = new_column(n + 1);
+
+  int pieces = 0;
+  for (int i = 0; i < n; i++) {
+    const Process *process = &processes[i];
+    table->id[i] = process->id;
+    table->arrival[i] = process->arrival_time;
+    table->lifetime[i] = process->lifetime;
+    table->start[i] = -1;
+    table->pages_needed[i] = process->pages_needed;
+    table->piece_offset[i] = pieces;
+    pieces += process->memory_pieces;
+  }
+  table->piece_offset[n] = pieces;
+
+  table->piece_capacity = pieces;
+  table->piece_pages = new_column(pieces);
+  for (int i = 0; i < n; i++) {
+    if (processes[i].memory_pieces == 0) continue;
+    memcpy(table->piece_pages + table->piece_offset[i],
+           processes[i].piece_pages,
+           processes[i].memory_pieces * sizeof(int));
+  }
+}
+
+/**
+ * Adds a copy of one process of another table.
+ *
+ * Args:
+ *   table (ProcessTable*): Table to add to.
+ *   from (const ProcessTable*): Table holding the process.
+ *   i (int): Index of the process in `from`.
+ *
+ * Behavior:
+ *   - Appends the process, not started, as the last row of `table`, growing
+ * the columns geometrically so appending n processes costs O(n) overall.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+void process_table_append(ProcessTable *table, const ProcessTable *from,
+                          int i) {
+  int n = table->count;
+  if (n == table->capacity) {
+    int capacity = n > 0 ? 2 * n : 16;
+    table->id = grow_column(table->id, capacity);
+    table->arrival = grow_column(table->arrival, capacity);
+    table->lifetime = grow_column(table->lifetime, capacity);
+    table->start = grow_column(table->start, capacity);
+    table->pages_needed = grow_column(table->pages_needed, capacity);
+    table->piece_offset = grow_column(table->piece_offset, capacity + 1);
+    table->capacity = capacity;
+  }
+
+  int pieces = process_piece_count(from, i);
+  int used = table->piece_offset[n];
+  if (used + pieces > table->piece_capacity) {
+    table->piece_capacity = 2 * (used + pieces);
+    table->piece_pages =
+        grow_column(table->piece_pages, table->piece_capacity);
+  }
+
+  table->id[n] = from->id[i];
+  table->arrival[n] = from->arrival[i];
+  table->lifetime[n] = from->lifetime[i];
+  table->start[n] = -1;
+  table->pages_needed[n] = from->pages_needed[i];
+  if (pieces > 0) {
+    memcpy(table->piece_pages + used, process_piece_pages(from, i),
+           pieces * sizeof(int));
+  }
+  table->piece_offset[n + 1] = used + pieces;
+  table->count = n + 1;
+}
+
+// Orders (arrival time, input position) pairs
+static int compare_arrivals(const void *a, const void *b) {
+  const int *x = a, *y = b;
+  if (x[0] != y[0]) return (x[0] > y[0]) - (x[0] < y[0]);
+  return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+/**
+ * Lists process indices by arrival time.
+ *
+ * Args:
+ *   table (const ProcessTable*): Processes to order.
+ *
+ * Returns:
+ *   int*: Newly allocated array of the `count` indices sorted by arrival
+ * time, ties in table order; the caller frees it.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+int *process_table_arrival_order(const ProcessTable *table) {
+  int num_processes = table->count;
+  int *pairs = new_column(2 * num_processes);
+  int *order = new_column(num_processes);
+  for (int i = 0; i < num_processes; i++) {
+    pairs[2 * i] = table->arrival[i];
+    pairs[2 * i + 1] = i;
+  }
+  qsort(pairs, num_processes, 2 * sizeof(int), compare_arrivals);
+  for (int i = 0; i < num_processes; i++) order[i] = pairs[2 * i + 1];
+  free(pairs);
+  return order;
+}
+
+/**
+ * Frees a process table.
+ *
+ * Args:
+ *   table (ProcessTable*): Table from `process_table_build`.
+ */
+void process_table_free(ProcessTable *table) {
+  free(table->id);
+  free(table->arrival);
+  free(table->lifetime);
+  free(table->start);
+  free(table->pages_needed);
+  free(table->piece_offset);
+  free(table->piece_pages);
+  table->count = 0;
+  table->capacity = 0;
+  table->piece_capacity = 0;
+}
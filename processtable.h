@@ -0,0 +1,44 @@
+#ifndef PROCESSTABLE_H
+#define PROCESSTABLE_H
+
+#include "parser.h"
+
+// Processes stored column by column, so a scan over one or two fields of
+// every process reads only those fields. Process i is element i of each
+// column; its pieces are elements piece_offset[i] up to piece_offset[i + 1]
+// of `piece_pages`.
+typedef struct {
+  int count;           // Number of processes
+  int capacity;        // Processes the columns have room for
+  int piece_capacity;  // Pieces `piece_pages` has room for
+  int *id;             // Process IDs
+  int *arrival;        // Arrival times
+  int *lifetime;       // Times spent in memory
+  int *start;          // Times moved to memory (-1 if not started yet)
+  int *pages_needed;   // Total pages needed across all pieces
+  int *piece_offset;   // Position of each process's first piece in
+                       // `piece_pages` (count + 1 entries)
+  int *piece_pages;    // Pages needed by each piece of every process, back
+                       // to back
+} ProcessTable;
+
+// Number of memory pieces of process `i`
+static inline int process_piece_count(const ProcessTable *table, int i) {
+  return table->piece_offset[i + 1] - table->piece_offset[i];
+}
+
+// Pages needed by each memory piece of process `i`
+static inline const int *process_piece_pages(const ProcessTable *table,
+                                             int i) {
+  return table->piece_pages + table->piece_offset[i];
+}
+
+// Function prototypes
+void process_table_build(ProcessTable *table, const Process *processes,
+                         int num_processes);
+void process_table_append(ProcessTable *table, const ProcessTable *from,
+                          int i);
+int *process_table_arrival_order(const ProcessTable *table);
+void process_table_free(ProcessTable *table);
+
+#endif
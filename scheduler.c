@@ -11,14 +11,15 @@
  *   queue (InputQueue*): Pointer to the input queue structure.
  *
  * Behavior:
- *   - Sets the front and rear pointers of the queue to NULL, indicating an
- * empty queue.
+ *   - Sets the front and rear pointers of the queue to NULL and the length to
+ * 0, indicating an empty queue.
  *   - This function must be called before performing any other queue
  * operations.
  */
 void init_queue(InputQueue *queue) {
   queue->front = NULL;
   queue->rear = NULL;
+  queue->length = 0;
 }
 
 /**
@@ -26,7 +27,7 @@ void init_queue(InputQueue *queue) {
  *
  * Args:
  *   queue (InputQueue*): Pointer to the input queue structure.
- *   process (Process): Process to be added to the queue.
+ *   process (int): Process-table index of the process to add.
  *
  * Behavior:
  *   - Dynamically allocates memory for a new queue node.
@@ -37,7 +38,7 @@ void init_queue(InputQueue *queue) {
  * Notes:
  *   - Exits the program with an error message if memory allocation fails.
  */
-void enqueue(InputQueue *queue, Process process) {
+void enqueue(InputQueue *queue, int process) {
   QueueNode *new_node = (QueueNode *)malloc(sizeof(QueueNode));
   if (!new_node) {
     perror("Error allocating memory for queue node");
@@ -53,6 +54,7 @@ void enqueue(InputQueue *queue, Process process) {
     queue->rear->next = new_node;
     queue->rear = new_node;
   }
+  queue->length++;
 }
 
 /**
@@ -62,7 +64,7 @@ void enqueue(InputQueue *queue, Process process) {
  *   queue (InputQueue*): Pointer to the input queue structure.
  *
  * Returns:
- *   Process: The process at the front of the queue.
+ *   int: Process-table index of the process at the front of the queue.
  *
  * Behavior:
  *   - Removes the node at the front of the queue.
@@ -74,14 +76,14 @@ void enqueue(InputQueue *queue, Process process) {
  *   - Exits the program with an error message if an attempt is made to dequeue
  * from an empty queue.
  */
-Process dequeue(InputQueue *queue) {
+int dequeue(InputQueue *queue) {
   if (queue->front == NULL) {
     fprintf(stderr, "Error: Attempt to dequeue from an empty queue.\n");
     exit(EXIT_FAILURE);
   }
 
   QueueNode *temp = queue->front;   // Temporary pointer to the front node
-  Process process = temp->process;  // Retrieve the process from the front node
+  int process = temp->process;  // Retrieve the process from the front node
 
   queue->front = queue->front->next;  // Move the front pointer to the next node
   if (queue->front == NULL) {         // If the queue is now empty
@@ -89,6 +91,45 @@ Process dequeue(InputQueue *queue) {
   }
 
   free(temp);  // Free the memory of the removed node
+  queue->length--;
+  return process;
+}
+
+/**
+ * Removes the process following a given node from the input queue.
+ *
+ * Args:
+ *   queue (InputQueue*): Pointer to the input queue structure.
+ *   prev (QueueNode*): Node before the one to remove, or NULL to remove the
+ * front of the queue.
+ *
+ * Returns:
+ *   int: Process-table index of the removed process.
+ *
+ * Behavior:
+ *   - Unlinks and frees the node, keeping the order of the others, and moves
+ * the rear pointer back to `prev` if the rear was removed.
+ *
+ * Notes:
+ *   - Exits the program with an error message if there is no node to remove.
+ */
+int remove_next(InputQueue *queue, QueueNode *prev) {
+  if (!prev) return dequeue(queue);
+  if (prev->next == NULL) {
+    fprintf(stderr, "Error: Attempt to remove past the end of the queue.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  QueueNode *temp = prev->next;
+  int process = temp->process;
+
+  prev->next = temp->next;
+  if (queue->rear == temp) {  // If the rear node was removed
+    queue->rear = prev;
+  }
+
+  free(temp);
+  queue->length--;
   return process;
 }
 
@@ -1,11 +1,9 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
-#include "parser.h"
-
 // A structure to represent a node in the input queue
 typedef struct QueueNode {
-  Process process;         // Process details
+  int process;             // Index of the process in the process table
   struct QueueNode *next;  // Pointer to the next node in the queue
 } QueueNode;
 
@@ -13,12 +11,14 @@ typedef struct QueueNode {
 typedef struct {
   QueueNode *front;  // Pointer to the front of the queue
   QueueNode *rear;   // Pointer to the rear of the queue
+  int length;        // Number of processes in the queue
 } InputQueue;
 
 // Function prototypes
 void init_queue(InputQueue *queue);
-void enqueue(InputQueue *queue, Process process);
-Process dequeue(InputQueue *queue);
+void enqueue(InputQueue *queue, int process);
+int dequeue(InputQueue *queue);
+int remove_next(InputQueue *queue, QueueNode *prev);
 int is_queue_empty(InputQueue *queue);
 
 #endif
@@ -0,0 +1,414 @@
+#include "shard.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Shards smaller than this are freed one after another, since handing a
+// deallocation to the workers costs more than scanning a small shard
+#define SHARD_PARALLEL_FRAMES 65536
+
+static void *allocate_or_exit(size_t bytes) {
+  void *block = malloc(bytes > 0 ? bytes : 1);
+  if (!block) {
+    perror("Error allocating memory for shards");
+    exit(EXIT_FAILURE);
+  }
+  return block;
+}
+
+// Frees process `set->release_id` from one thread's share of the shards
+static void release_shards(ShardSet *set, int first) {
+  for (int k = first; k < set->count; k += set->threads) {
+    set->freed[k] = release_process(&set->nodes[k], set->release_id);
+  }
+}
+
+// Frees its share of the shards once per deallocation until told to stop
+static void *run_worker(void *arg) {
+  ShardWorker *worker = arg;
+  ShardSet *set = worker->set;
+  for (;;) {
+    pthread_barrier_wait(&set->start);
+    if (set->stopping) return NULL;
+    release_shards(set, worker->first);
+    pthread_barrier_wait(&set->done);
+  }
+}
+
+// Starts a worker per online CPU after the first, at most one per shard, if
+// the shards are large enough to be worth it. More threads than CPUs would
+// only take turns, and each would still wait at the barriers.
+static void start_workers(ShardSet *set) {
+  int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  if (threads > set->count) threads = set->count;
+  if (threads < 1 || set->frames < SHARD_PARALLEL_FRAMES) threads = 1;
+#ifdef SIM_COUNTERS
+  // Counters are plain globals, so counting builds free shards one by one
+  threads = 1;
+#endif
+  set->threads = threads;
+  set->workers = NULL;
+  set->stopping = 0;
+  if (threads == 1) return;
+
+  pthread_barrier_init(&set->start, NULL, threads);
+  pthread_barrier_init(&set->done, NULL, threads);
+  set->workers = allocate_or_exit((threads - 1) * sizeof(ShardWorker));
+  for (int t = 1; t < threads; t++) {
+    ShardWorker *worker = &set->workers[t - 1];
+    worker->set = set;
+    worker->first = t;
+    if (pthread_create(&worker->thread, NULL, run_worker, worker) != 0) {
+      perror("Error starting shard worker");
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+static void stop_workers(ShardSet *set) {
+  if (!set->workers) return;
+  set->stopping = 1;
+  pthread_barrier_wait(&set->start);
+  for (int t = 1; t < set->threads; t++) {
+    pthread_join(set->workers[t - 1].thread, NULL);
+  }
+  pthread_barrier_destroy(&set->start);
+  pthread_barrier_destroy(&set->done);
+  free(set->workers);
+  set->workers = NULL;
+}
+
+/**
+ * Splits a memory system into equal shards.
+ *
+ * Args:
+ *   memory (Memory*): Pointer to a freshly initialized `Memory` structure.
+ *   count (int): Number of shards.
+ *   policy (ShardPolicy): How `allocate_memory` places processes over the
+ * shards.
+ *
+ * Returns:
+ *   int: 1 on success, 0 if the frames do not divide evenly into `count`
+ * shards or the extent table is in use.
+ *
+ * Behavior:
+ *   - Gives each shard its own page table (compact if `memory` has one),
+ * free-frame tree and allocator of the same strategy, and releases the
+ * unsplit ones; every other memory function then works across the shards
+ * with frames numbered as before.
+ *   - Starts a worker thread per additional online CPU, at most one per
+ * additional shard, when shards hold at least SHARD_PARALLEL_FRAMES frames,
+ * so a deallocation frees the shards in parallel.
+ */
+int shard_split(Memory *memory, int count, ShardPolicy policy) {
+  if (count < 1 || memory->extents || memory->shards ||
+      memory->total_pages % count != 0) {
+    return 0;
+  }
+
+  ShardSet *set = allocate_or_exit(sizeof(ShardSet));
+  set->count = count;
+  set->frames = memory->total_pages / count;
+  set->policy = policy;
+  set->nodes = allocate_or_exit(count * sizeof(Memory));
+  set->freed = allocate_or_exit(count * sizeof(int));
+  for (int k = 0; k < count; k++) {
+    Memory *node = &set->nodes[k];
+    init_memory_policy(node, set->frames * memory->page_size,
+                       memory->page_size, memory->policy);
+    if (memory->compact) use_compact_table(node);
+  }
+
+  // Every access now goes through the shards
+  free_memory(memory);
+  memory->shards = set;
+  start_workers(set);
+  return 1;
+}
+
+/**
+ * Looks up a shard placement policy by its command-line name.
+ *
+ * Args:
+ *   name (const char*): Policy name ("local", "interleave" or "spill").
+ *   policy (ShardPolicy*): Receives the matching policy.
+ *
+ * Returns:
+ *   int: 1 if the name is known, 0 otherwise.
+ */
+int parse_shard_policy(const char *name, ShardPolicy *policy) {
+  if (strcmp(name, "local") == 0) {
+    *policy = SHARD_LOCAL;
+  } else if (strcmp(name, "interleave") == 0) {
+    *policy = SHARD_INTERLEAVE;
+  } else if (strcmp(name, "spill") == 0) {
+    *policy = SHARD_SPILL;
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+// Undoes a partial placement by freeing the process from the `touched`
+// shards starting at `first` (in shard order, wrapping around), which are
+// the only ones it was written to
+static void release_touched(ShardSet *set, int first, int touched,
+                            int process_id) {
+  for (int d = 0; d < touched; d++) {
+    release_process(&set->nodes[(first + d) % set->count], process_id);
+  }
+}
+
+// Places the whole process on the first shard from `home` on that holds it
+static int allocate_local(ShardSet *set, int home, int process_id,
+                          int num_pieces, const int *piece_pages,
+                          int total_pages_needed) {
+  for (int d = 0; d < set->count; d++) {
+    Memory *node = &set->nodes[(home + d) % set->count];
+    if (place_process(node, process_id, num_pieces, piece_pages,
+                      total_pages_needed)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Deals the process's pages (or pieces) round-robin from `home`, then places
+// each shard's share as one request
+static int allocate_interleave(ShardSet *set, int home, int process_id,
+                               int num_pieces, const int *piece_pages) {
+  int paging = set->nodes[0].policy == ALLOC_PAGING;
+
+  // share[k * num_pieces + j] is the j-th piece placed on shard k
+  int *share = allocate_or_exit((size_t)set->count * num_pieces * sizeof(int));
+  int *pieces = calloc(set->count, sizeof(int));
+  int *pages = calloc(set->count, sizeof(int));
+  if (!pieces || !pages) {
+    perror("Error allocating memory for shards");
+    exit(EXIT_FAILURE);
+  }
+
+  int dealt = 0;  // Pages dealt so far; page p goes to shard home + p
+  for (int i = 0; i < num_pieces; i++) {
+    if (!paging) {
+      int k = (home + i) % set->count;
+      share[k * num_pieces + pieces[k]++] = piece_pages[i];
+      pages[k] += piece_pages[i];
+      continue;
+    }
+    for (int d = 0; d < set->count; d++) {
+      int count = piece_pages[i] / set->count;
+      count += d < piece_pages[i] % set->count;
+      if (count == 0) continue;
+      int k = (home + dealt + d) % set->count;
+      share[k * num_pieces + pieces[k]++] = count;
+      pages[k] += count;
+    }
+    dealt += piece_pages[i];
+  }
+
+  // Paging places a share exactly when the shard has that many free pages,
+  // so every share is checked before anything is written
+  int allocated = 1;
+  for (int k = 0; k < set->count && paging && allocated; k++) {
+    allocated = memory_free_summary(&set->nodes[k]).free_pages >= pages[k];
+  }
+
+  int placed = 0;  // Shards 0 to placed - 1 hold their share
+  while (allocated && placed < set->count) {
+    int k = placed;
+    if (pieces[k] > 0) {
+      allocated = place_process(&set->nodes[k], process_id, pieces[k],
+                                share + k * num_pieces, pages[k]);
+    }
+    if (allocated) placed++;
+  }
+  if (!allocated) release_touched(set, 0, placed, process_id);
+
+  free(share);
+  free(pieces);
+  free(pages);
+  return allocated;
+}
+
+// Places each piece on `home` while it has room, spilling over to the
+// following shards (splitting pieces across shards only when paging)
+static int allocate_spill(ShardSet *set, int home, int process_id,
+                          int num_pieces, const int *piece_pages,
+                          int total_pages_needed) {
+  int paging = set->nodes[0].policy == ALLOC_PAGING;
+  if (paging && shard_free_summary(set).free_pages < total_pages_needed) {
+    return 0;  // Not enough memory in all shards together, must wait
+  }
+
+  // With paging the check above means every piece fits; otherwise `touched`
+  // tracks how far from `home` pieces were placed, for undoing a failure
+  int touched = 0;
+  for (int i = 0; i < num_pieces; i++) {
+    int left = piece_pages[i];
+    for (int d = 0; d < set->count && left > 0; d++) {
+      Memory *node = &set->nodes[(home + d) % set->count];
+      int pages = left;
+      if (paging) {
+        int free_pages = memory_free_summary(node).free_pages;
+        if (pages > free_pages) pages = free_pages;
+        if (pages == 0) continue;
+      }
+      if (place_process(node, process_id, 1, &pages, pages)) {
+        left -= pages;
+        if (d >= touched) touched = d + 1;
+      }
+    }
+    if (left > 0) {
+      release_touched(set, home, touched, process_id);
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Allocates memory for a process across the shards.
+ *
+ * Args:
+ *   set (ShardSet*): Shards of the memory system.
+ *   process_id (int): The ID of the process requesting memory allocation.
+ *   num_pieces (int): Number of memory segments (pieces) required.
+ *   piece_pages (const int*): Pages needed by each memory segment.
+ *   total_pages_needed (int): Sum of `piece_pages`.
+ *
+ * Returns:
+ *   int: 1 if the process was placed, 0 if it must wait.
+ *
+ * Behavior:
+ *   - Places the process by `set->policy`, starting at its home shard
+ * (process ID modulo the shard count). Each shard places its share with the
+ * memory's own strategy.
+ *   - All or nothing: a process that cannot be placed completely leaves
+ * every shard as it was. With paging the shards' free page counts are
+ * checked before anything is written; otherwise only the shards written to
+ * are released again.
+ */
+int shard_allocate(ShardSet *set, int process_id, int num_pieces,
+                   const int *piece_pages, int total_pages_needed) {
+  int home = process_id % set->count;
+  switch (set->policy) {
+    case SHARD_LOCAL:
+      return allocate_local(set, home, process_id, num_pieces, piece_pages,
+                            total_pages_needed);
+    case SHARD_INTERLEAVE:
+      return allocate_interleave(set, home, process_id, num_pieces,
+                                 piece_pages);
+    default:
+      return allocate_spill(set, home, process_id, num_pieces, piece_pages,
+                            total_pages_needed);
+  }
+}
+
+/**
+ * Frees a process's frames in every shard.
+ *
+ * Args:
+ *   set (ShardSet*): Shards of the memory system.
+ *   process_id (int): ID of the process whose frames are freed.
+ *
+ * Returns:
+ *   int: Number of frames freed.
+ *
+ * Notes:
+ *   - Shards share no state, so with worker threads the shards are split
+ * evenly over the online CPUs and scanned at the same time.
+ */
+int shard_deallocate(ShardSet *set, int process_id) {
+  set->release_id = process_id;
+  if (set->workers) {
+    pthread_barrier_wait(&set->start);
+    release_shards(set, 0);
+    pthread_barrier_wait(&set->done);
+  } else {
+    release_shards(set, 0);
+  }
+
+  int frames_freed = 0;
+  for (int k = 0; k < set->count; k++) {
+    frames_freed += set->freed[k];
+  }
+  return frames_freed;
+}
+
+// Gives a range of global frames to a process or frees it, shard by shard
+void shard_set_frame_owner(ShardSet *set, int start, int length, int owner) {
+  while (length > 0) {
+    int offset = start % set->frames;
+    int run = set->frames - offset;
+    if (run > length) run = length;
+    set_frame_owner(&set->nodes[start / set->frames], offset, run, owner);
+    start += run;
+    length -= run;
+  }
+}
+
+// Process ID owning a global frame, or -1 if the frame is free
+int shard_frame_owner(const ShardSet *set, int frame) {
+  return frame_owner(&set->nodes[frame / set->frames], frame % set->frames);
+}
+
+// First global frame at or after `from` owned by `owner` (-1 for free), or
+// the total number of frames if there is none
+int shard_find_frame(const ShardSet *set, int from, int owner) {
+  for (int k = from / set->frames; k < set->count; k++) {
+    int base = k * set->frames;
+    int local = from > base ? from - base : 0;
+    int frame = find_frame(&set->nodes[k], local, owner);
+    if (frame < set->frames) return base + frame;
+  }
+  return set->count * set->frames;
+}
+
+/**
+ * Reports the free space of every shard together.
+ *
+ * Args:
+ *   set (const ShardSet*): Shards of the memory system.
+ *
+ * Returns:
+ *   FreeSummary: Free frames and free runs summed over the shards, and the
+ * longest free run of any shard.
+ *
+ * Notes:
+ *   - Runs do not continue across shard boundaries, since no allocation can
+ * use frames of two shards as one contiguous range.
+ */
+FreeSummary shard_free_summary(const ShardSet *set) {
+  FreeSummary total = {0, 0, 0};
+  for (int k = 0; k < set->count; k++) {
+    FreeSummary node = memory_free_summary(&set->nodes[k]);
+    total.free_pages += node.free_pages;
+    total.free_runs += node.free_runs;
+    if (node.largest_free_run > total.largest_free_run) {
+      total.largest_free_run = node.largest_free_run;
+    }
+  }
+  return total;
+}
+
+/**
+ * Stops the worker threads and frees every shard.
+ *
+ * Args:
+ *   memory (Memory*): Memory split with `shard_split`, or not split at all.
+ */
+void shard_free(Memory *memory) {
+  ShardSet *set = memory->shards;
+  if (!set) return;
+  stop_workers(set);
+  for (int k = 0; k < set->count; k++) {
+    free_memory(&set->nodes[k]);
+  }
+  free(set->nodes);
+  free(set->freed);
+  free(set);
+  memory->shards = NULL;
+}
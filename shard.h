@@ -0,0 +1,58 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <pthread.h>
+
+#include "memory.h"
+
+// How processes are spread over the shards of a sharded memory. A process's
+// home shard is its ID modulo the number of shards.
+typedef enum {
+  SHARD_LOCAL,       // Whole process on its home shard, or else on the next
+                     // shard (in shard order) that holds all of it
+  SHARD_INTERLEAVE,  // Pages dealt round-robin over every shard starting at
+                     // the home shard (whole pieces for contiguous strategies)
+  SHARD_SPILL,       // Home shard filled first, the rest spilling over to the
+                     // following shards
+} ShardPolicy;
+
+// Worker thread freeing every `threads`-th shard of a deallocation
+typedef struct ShardWorker {
+  pthread_t thread;      // The thread
+  struct ShardSet *set;  // Shards it belongs to
+  int first;             // First shard it frees
+} ShardWorker;
+
+// Memory split into equal NUMA-style shards, each a complete `Memory` with
+// its own page table, free-frame tree and allocator. Shard k holds global
+// frames k * frames up to (k + 1) * frames - 1.
+typedef struct ShardSet {
+  int count;           // Number of shards
+  int frames;          // Frames per shard
+  ShardPolicy policy;  // How processes are placed over the shards
+  Memory *nodes;       // Each shard, with frames numbered from 0
+
+  // Deallocation frees the shards on `threads` threads at once when shards
+  // are large enough to be worth it (`workers` is NULL when one)
+  int threads;              // Threads freeing shards, the caller included
+  ShardWorker *workers;     // Threads 1 to threads - 1
+  pthread_barrier_t start;  // Releases the workers onto a deallocation
+  pthread_barrier_t done;   // Waits for every shard to finish
+  int release_id;           // Process being deallocated
+  int *freed;               // Frames each shard freed
+  int stopping;             // Set to make the workers exit
+} ShardSet;
+
+// Function prototypes
+int shard_split(Memory *memory, int count, ShardPolicy policy);
+int parse_shard_policy(const char *name, ShardPolicy *policy);
+int shard_allocate(ShardSet *set, int process_id, int num_pieces,
+                   const int *piece_pages, int total_pages_needed);
+int shard_deallocate(ShardSet *set, int process_id);
+void shard_set_frame_owner(ShardSet *set, int start, int length, int owner);
+int shard_frame_owner(const ShardSet *set, int frame);
+int shard_find_frame(const ShardSet *set, int from, int owner);
+FreeSummary shard_free_summary(const ShardSet *set);
+void shard_free(Memory *memory);
+
+#endif
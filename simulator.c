@@ -0,0 +1,628 @@
+#include "simulator.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "counters.h"
+#include "snapshot.h"
+#include "timing.h"
+
+// Most queued processes placed with one allocate_memory_batch call
+#define ADMIT_BATCH 64
+
+// Function to print the current state of the input queue
+static void print_input_queue(Simulator *sim) {
+  FILE *out = sim->out;
+  fprintf(out, "       Input Queue:[");
+  QueueNode *node = sim->queue.front;
+  while (node) {
+    fprintf(out, "%d", sim->processes.id[node->process]);
+    if (node->next) fprintf(out, " ");
+    node = node->next;
+  }
+  fprintf(out, "]\n");
+}
+
+// Prints the "t = <clock>:" header the first time an event happens in a tick
+// (trace records carry the time themselves)
+static void begin_event(Simulator *sim, int *event_occurred) {
+  if (!*event_occurred) {
+    if (!sim->trace && sim->output >= OUTPUT_EVENTS) {
+      fprintf(sim->out, "\nt = %d:\n", sim->clock);
+    }
+    *event_occurred = 1;
+  }
+  sim->events++;
+}
+
+// Records memory use and fragmentation after frames changed owner
+static void sample_memory(Simulator *sim) {
+  FreeSummary summary = memory_free_summary(sim->memory);
+  SimStats *stats = &sim->stats;
+  time_weighted_set(&stats->memory_used, sim->clock,
+                    sim->memory->total_pages - summary.free_pages);
+  time_weighted_set(&stats->free_runs, sim->clock, summary.free_runs);
+  time_weighted_set(&stats->largest_free_run, sim->clock,
+                    summary.largest_free_run);
+}
+
+// Writes one trace record per run of frames the process owns
+static void trace_runs(Simulator *sim, EventType type, int process_id) {
+  int frame = 0, length;
+  while (find_owned_run(sim->memory, process_id, &frame, &length)) {
+    trace_event(sim->trace, type, sim->clock, process_id, frame, length);
+    frame += length;
+  }
+}
+
+// Logs and records the admission of the queued process after `prev` (the
+// head if `prev` is NULL), which has just been placed in memory
+static void record_admission(Simulator *sim, QueueNode *prev,
+                             int *event_occurred) {
+  Memory *memory = sim->memory;
+  ProcessTable *processes = &sim->processes;
+  int clock = sim->clock;
+  int next = (prev ? prev->next : sim->queue.front)->process;
+  int id = processes->id[next];
+
+  // Mark the start time for this process
+  processes->start[next] = clock;  // Process starts now
+
+  begin_event(sim, event_occurred);
+  remove_next(&sim->queue, prev);
+  sim->head_blocked = 0;
+  histogram_record(&sim->stats.wait, clock - processes->arrival[next]);
+  time_weighted_set(&sim->stats.queue_length, clock, sim->queue.length);
+  sample_memory(sim);
+  if (sim->trace) {
+    trace_event(sim->trace, EVENT_ADMISSION, clock, id, 0, 0);
+    trace_runs(sim, EVENT_ALLOC, id);
+  } else if (sim->output >= OUTPUT_EVENTS) {
+    fprintf(sim->out, "       MM moves Process %d to memory\n", id);
+
+    // Print input queue state
+    print_input_queue(sim);
+
+    // Print memory map after allocation
+    if (sim->output >= OUTPUT_FULL_MAPS) {
+      print_memory_map(memory, memory->page_size, sim->out);
+    }
+  }
+}
+
+// Moves the queued process after `prev` (the head if `prev` is NULL) into
+// memory if it fits, logging the admission. Returns 1 if it was admitted.
+static int admit(Simulator *sim, QueueNode *prev, int *event_occurred) {
+  ProcessTable *processes = &sim->processes;
+  int next = (prev ? prev->next : sim->queue.front)->process;
+
+  // Allocate memory if possible
+  if (!allocate_memory(sim->memory, processes->id[next],
+                       process_piece_count(processes, next),
+                       process_piece_pages(processes, next),
+                       processes->pages_needed[next])) {
+    return 0;
+  }
+
+  // Placement is timed as TIMER_ALLOCATE, as it is for a batch
+  TIMER_START(start);
+  record_admission(sim, prev, event_occurred);
+  TIMER_STOP(TIMER_ADMISSION, start);
+  return 1;
+}
+
+// Whether FCFS admissions can be placed in batches. Each admission's memory
+// map would show the whole batch already placed, and memory statistics are
+// sampled after the batch, which only records the same extremes when
+// placements never split a free run (first-fit paging).
+static int can_admit_in_batches(const Simulator *sim) {
+  return (sim->trace || sim->output < OUTPUT_FULL_MAPS) &&
+         sim->memory->policy == ALLOC_PAGING;
+}
+
+// Moves processes from the front of the queue into memory until the queue
+// is empty or its head does not fit, placing up to ADMIT_BATCH of them with
+// one `allocate_memory_batch` call. Returns 1 if the queue emptied.
+static int admit_batch(Simulator *sim, int *event_occurred) {
+  ProcessTable *processes = &sim->processes;
+  AllocRequest requests[ADMIT_BATCH];
+  int count = 0;
+  for (QueueNode *node = sim->queue.front; node && count < ADMIT_BATCH;
+       node = node->next) {
+    int i = node->process;
+    requests[count].process_id = processes->id[i];
+    requests[count].num_pieces = process_piece_count(processes, i);
+    requests[count].piece_pages = process_piece_pages(processes, i);
+    requests[count].total_pages_needed = processes->pages_needed[i];
+    count++;
+  }
+
+  int placed = allocate_memory_batch(sim->memory, requests, count);
+  for (int k = 0; k < placed; k++) {
+    TIMER_START(start);
+    record_admission(sim, NULL, event_occurred);
+    TIMER_STOP(TIMER_ADMISSION, start);
+  }
+  return placed == count;
+}
+
+/**
+ * Looks up an admission policy by its command-line name.
+ *
+ * Args:
+ *   name (const char*): Policy name ("fcfs" or "backfill").
+ *   policy (AdmissionPolicy*): Receives the matching policy.
+ *
+ * Returns:
+ *   int: 1 if the name is known, 0 otherwise.
+ */
+int parse_admission_policy(const char *name, AdmissionPolicy *policy) {
+  if (strcmp(name, "fcfs") == 0) {
+    *policy = ADMIT_FCFS;
+  } else if (strcmp(name, "backfill") == 0) {
+    *policy = ADMIT_BACKFILL;
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Looks up an output level by its command-line flag.
+ *
+ * Args:
+ *   flag (const char*): Flag ("--quiet", "--summary", "--events" or
+ * "--full-maps").
+ *   level (OutputLevel*): Receives the matching level.
+ *
+ * Returns:
+ *   int: 1 if the flag is known, 0 otherwise.
+ */
+int parse_output_level(const char *flag, OutputLevel *level) {
+  if (strcmp(flag, "--quiet") == 0) {
+    *level = OUTPUT_QUIET;
+  } else if (strcmp(flag, "--summary") == 0) {
+    *level = OUTPUT_SUMMARY;
+  } else if (strcmp(flag, "--events") == 0) {
+    *level = OUTPUT_EVENTS;
+  } else if (strcmp(flag, "--full-maps") == 0) {
+    *level = OUTPUT_FULL_MAPS;
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+// Command-line name of an admission policy
+const char *admission_policy_name(AdmissionPolicy policy) {
+  return policy == ADMIT_BACKFILL ? "backfill" : "fcfs";
+}
+
+/**
+ * Initializes a simulation run.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator to initialize.
+ *   processes (const Process*): Parsed processes, with page demand computed
+ * for the memory's page size. They are copied into `sim->processes` and not
+ * referenced afterwards.
+ *   num_processes (int): Number of processes.
+ *   memory (Memory*): Initialized memory the processes are placed in.
+ *   out (FILE*): Stream the event log is written to.
+ *
+ * Behavior:
+ *   - Marks every process as not started and starts the clock at 0 with an
+ * empty input queue.
+ *   - Sorts the processes by arrival time once, so each tick finds its
+ * arrivals without scanning every process.
+ *   - Admits queued processes FCFS and writes the full text log; set
+ * `sim->admission` or `sim->output` afterwards to change that.
+ */
+void sim_init(Simulator *sim, const Process *processes, int num_processes,
+              Memory *memory, FILE *out) {
+  process_table_build(&sim->processes, processes, num_processes);
+  sim->memory = memory;
+  sim->out = out;
+  sim->trace = NULL;
+  sim->admission = ADMIT_FCFS;
+  sim->output = OUTPUT_FULL_MAPS;
+  init_queue(&sim->queue);
+  sim->arrival_order = process_table_arrival_order(&sim->processes);
+  sim->next_arrival = 0;
+  sim->clock = 0;
+  sim->total_turnaround = 0;
+  sim->completed_processes = 0;
+  sim->events = 0;
+  stats_init(&sim->stats, memory->total_pages);
+
+  // Free-memory generation at which the queue head last failed to fit. The
+  // head can only fit once something has been freed, so retrying before the
+  // generation changes is skipped.
+  sim->head_blocked = 0;
+  sim->blocked_generation = 0;
+}
+
+/**
+ * Changes how a simulation in progress admits queued processes.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator.
+ *   policy (AdmissionPolicy): Policy used from the next tick on.
+ *
+ * Behavior:
+ *   - Forgets a failed admission attempt made under another policy: a queue
+ * head that did not fit under FCFS says nothing about the processes behind
+ * it, which backfill may still admit.
+ */
+void sim_set_admission(Simulator *sim, AdmissionPolicy policy) {
+  if (sim->admission != policy) sim->head_blocked = 0;
+  sim->admission = policy;
+}
+
+/**
+ * Hands a simulation one more process to run.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator.
+ *   from (const ProcessTable*): Table holding the process.
+ *   i (int): Index of the process in `from`.
+ *
+ * Behavior:
+ *   - Appends the process to `sim->processes`, to arrive at its arrival
+ * time. This lets a dispatcher feed processes to the simulation as they
+ * arrive instead of all at `sim_init`.
+ *
+ * Notes:
+ *   - The process must not arrive before `sim->clock` or before any process
+ * added earlier, so the arrival order stays sorted.
+ */
+void sim_add_process(Simulator *sim, const ProcessTable *from, int i) {
+  ProcessTable *processes = &sim->processes;
+  int capacity = processes->capacity;
+  process_table_append(processes, from, i);
+  if (processes->capacity != capacity) {
+    int *order = realloc(sim->arrival_order,
+                         processes->capacity * sizeof(int));
+    if (!order) {
+      perror("Error allocating memory for arrival order");
+      exit(EXIT_FAILURE);
+    }
+    sim->arrival_order = order;
+  }
+  sim->arrival_order[processes->count - 1] = processes->count - 1;
+}
+
+/**
+ * Simulates one clock tick and advances the clock.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator.
+ *
+ * Behavior:
+ *   1. Enqueues the processes arriving at this tick, in input order.
+ *   2. Completes the processes whose lifetime ends at this tick, in input
+ * order, and frees their memory.
+ *   3. Moves processes from the front of the input queue into memory until the
+ * queue is empty or its head does not fit (ADMIT_FCFS, no skipping ahead),
+ * or every queued process that fits, in queue order (ADMIT_BACKFILL).
+ *   - Each event is logged to `sim->out`, followed by the input queue and/or
+ * the memory map as appropriate, as far as `sim->output` asks for. Maps and
+ * event lines below that level are never formatted.
+ *   - With `sim->trace` set, each event is instead written as a trace record,
+ * with one alloc or free record per run of frames an admission or completion
+ * changes.
+ */
+void sim_step(Simulator *sim) {
+  ProcessTable *processes = &sim->processes;
+  Memory *memory = sim->memory;
+  int clock = sim->clock;
+  int event_occurred = 0;
+  int arrived = 0;
+
+  // Skip processes whose arrival time has passed (only possible for
+  // negative arrival times, which never arrive)
+  while (sim->next_arrival < processes->count &&
+         processes->arrival[sim->arrival_order[sim->next_arrival]] < clock) {
+    sim->next_arrival++;
+  }
+
+  // Dynamically enqueue processes based on arrival time
+  while (sim->next_arrival < processes->count &&
+         processes->arrival[sim->arrival_order[sim->next_arrival]] == clock) {
+    int i = sim->arrival_order[sim->next_arrival++];
+    TIMER_START(start);
+    begin_event(sim, &event_occurred);
+    enqueue(&sim->queue, i);
+    arrived = 1;
+    COUNTER_MAX(queue_max_depth, sim->queue.length);
+    time_weighted_set(&sim->stats.queue_length, clock, sim->queue.length);
+    if (sim->trace) {
+      trace_event(sim->trace, EVENT_ARRIVAL, clock, processes->id[i], 0, 0);
+    } else if (sim->output >= OUTPUT_EVENTS) {
+      fprintf(sim->out, "       Process %d arrives\n", processes->id[i]);
+
+      // Print input queue state
+      print_input_queue(sim);
+    }
+    TIMER_STOP(TIMER_ARRIVAL, start);
+  }
+
+  // Check for process completions (FCFS order for same completion time).
+  // Only the start and lifetime columns are read for every process.
+  const int *start_time = processes->start;
+  const int *lifetime = processes->lifetime;
+  for (int i = 0; i < processes->count; i++) {
+    // Only consider completion if the process has actually started
+    if (start_time[i] != -1 && start_time[i] + lifetime[i] == clock) {
+      int id = processes->id[i];
+      TIMER_START(start);
+      begin_event(sim, &event_occurred);
+      if (sim->trace) {
+        trace_event(sim->trace, EVENT_COMPLETION, clock, id, 0, 0);
+        trace_runs(sim, EVENT_FREE, id);
+        deallocate_memory(memory, id);
+      } else {
+        if (sim->output >= OUTPUT_EVENTS) {
+          fprintf(sim->out, "       Process %d completes\n", id);
+        }
+        deallocate_memory(memory, id);
+
+        // Print memory map after deallocation
+        if (sim->output >= OUTPUT_FULL_MAPS) {
+          print_memory_map(memory, memory->page_size, sim->out);
+        }
+      }
+
+      int turnaround = clock - processes->arrival[i];
+      sim->total_turnaround += turnaround;
+      sim->completed_processes++;
+      histogram_record(&sim->stats.turnaround, turnaround);
+      sample_memory(sim);
+      TIMER_STOP(TIMER_COMPLETION, start);
+    }
+  }
+
+  // Attempt to allocate memory for processes in the queue. Nothing queued
+  // can fit until memory is freed, except (with backfill) new arrivals.
+  if (!is_queue_empty(&sim->queue) &&
+      !(sim->head_blocked &&
+        sim->blocked_generation == memory->free_generation &&
+        (sim->admission == ADMIT_FCFS || !arrived))) {
+    if (sim->admission == ADMIT_FCFS && can_admit_in_batches(sim)) {
+      while (!is_queue_empty(&sim->queue) &&
+             admit_batch(sim, &event_occurred)) {
+      }
+    } else if (sim->admission == ADMIT_FCFS) {
+      while (!is_queue_empty(&sim->queue) &&
+             admit(sim, NULL, &event_occurred)) {
+      }
+    } else {
+      QueueNode *prev = NULL;
+      QueueNode *node = sim->queue.front;
+      while (node) {
+        if (admit(sim, prev, &event_occurred)) {
+          node = prev ? prev->next : sim->queue.front;
+        } else {
+          prev = node;
+          node = node->next;
+        }
+      }
+    }
+
+    // Whatever is still queued waits for memory to be freed
+    if (!is_queue_empty(&sim->queue)) {
+      sim->head_blocked = 1;
+      sim->blocked_generation = memory->free_generation;
+    }
+  }
+
+  COUNTER_ADD(ticks, 1);
+  COUNTER_ADD(idle_ticks, !event_occurred);
+
+  // Increment clock
+  sim->clock++;
+}
+
+/**
+ * Simulates clock ticks until the clock passes `end_time`.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator.
+ *   end_time (int): Last clock tick to simulate.
+ */
+void sim_run(Simulator *sim, int end_time) {
+  while (sim->clock <= end_time) {
+    sim_step(sim);
+  }
+}
+
+/**
+ * Prints the average turnaround time of the completed processes.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator.
+ *
+ * Notes:
+ *   - Prints nothing when `sim->trace` is set or `sim->output` is
+ * OUTPUT_QUIET.
+ */
+void sim_print_summary(Simulator *sim) {
+  // Trace consumers derive turnaround from the records themselves
+  if (sim->trace || sim->output < OUTPUT_SUMMARY) return;
+
+  // Calculate and print the average turnaround time
+  if (sim->completed_processes > 0) {
+    fprintf(sim->out, "\nAverage Turnaround Time: %.2f\n",
+            sim->total_turnaround / sim->completed_processes);
+  } else {
+    fprintf(sim->out, "No processes completed. Average Turnaround Time: N/A\n");
+  }
+}
+
+/**
+ * Prints the wait, turnaround, memory and queue statistics of the run so far.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator.
+ *   out (FILE*): Stream to print to.
+ *   json (int): 1 for a single JSON object, 0 for a readable summary block.
+ *
+ * Notes:
+ *   - Time-weighted metrics cover ticks 0 up to (not including) `sim->clock`.
+ * The run can continue afterwards; its statistics are left untouched.
+ */
+void sim_print_stats(Simulator *sim, FILE *out, int json) {
+  SimStats finished = sim->stats;
+  stats_finish(&finished, sim->clock);
+  print_stats(out, &finished, json);
+}
+
+// FNV-1a hash of the process table, so a checkpoint is only restored
+// against the input it was taken from
+static uint64_t fingerprint(const Simulator *sim) {
+  uint64_t hash = 14695981039346656037u;
+  const ProcessTable *p = &sim->processes;
+  for (int i = 0; i < p->count; i++) {
+    int fields[] = {p->id[i], p->arrival[i], p->lifetime[i],
+                    p->pages_needed[i]};
+    for (int f = 0; f < 4; f++) {
+      hash = (hash ^ (uint32_t)fields[f]) * 1099511628211u;
+    }
+  }
+  return hash;
+}
+
+/**
+ * Writes a checkpoint of the simulation between two ticks.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator.
+ *   file (FILE*): Binary stream the checkpoint is written to.
+ *
+ * Behavior:
+ *   - Writes the clock, arrival cursor, turnaround totals, admission policy,
+ * retry state, every process's start time, the input queue, the statistics
+ * and the memory state, as variable-length integers.
+ *   - The process table itself is not written; it is re-read from the input
+ * file on restore and checked against a fingerprint.
+ */
+void sim_save(Simulator *sim, FILE *file) {
+  fwrite(SNAPSHOT_MAGIC, 1, strlen(SNAPSHOT_MAGIC), file);
+  snapshot_write_int(file, sim->processes.count);
+  snapshot_write_int(file, (int64_t)fingerprint(sim));
+
+  snapshot_write_int(file, sim->clock);
+  snapshot_write_int(file, sim->next_arrival);
+  snapshot_write_double(file, sim->total_turnaround);
+  snapshot_write_int(file, sim->completed_processes);
+  snapshot_write_int(file, sim->events);
+  snapshot_write_int(file, sim->admission);
+  snapshot_write_int(file, sim->head_blocked);
+  snapshot_write_int(file, sim->blocked_generation);
+
+  for (int i = 0; i < sim->processes.count; i++) {
+    snapshot_write_int(file, sim->processes.start[i]);
+  }
+
+  snapshot_write_int(file, sim->queue.length);
+  for (QueueNode *node = sim->queue.front; node; node = node->next) {
+    snapshot_write_int(file, sim->processes.id[node->process]);
+  }
+
+  stats_save(file, &sim->stats);
+  memory_save(sim->memory, file);
+}
+
+/**
+ * Resumes a simulation from a checkpoint written by `sim_save`.
+ *
+ * Args:
+ *   sim (Simulator*): Simulator freshly set up by `sim_init` with the same
+ * processes, and memory of the same configuration, as the checkpointed run.
+ *   file (FILE*): Binary stream the checkpoint is read from.
+ *
+ * Behavior:
+ *   - Continuing with `sim_run` produces the events, statistics and summary
+ * the uninterrupted run would have produced from the checkpoint on.
+ *   - Queued processes are matched to the process table in arrival order,
+ * since the input queue is always a subsequence of the arrivals so far.
+ *   - Keeps `sim->admission`. Resuming under another policy than the
+ * checkpointed run's retries admission on the next tick, as
+ * `sim_set_admission` does.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the checkpoint is malformed
+ * or was taken from a different input or memory configuration.
+ */
+void sim_restore(Simulator *sim, FILE *file) {
+  char magic[sizeof(SNAPSHOT_MAGIC)] = {0};
+  if (fread(magic, 1, strlen(SNAPSHOT_MAGIC), file) != strlen(SNAPSHOT_MAGIC) ||
+      strcmp(magic, SNAPSHOT_MAGIC) != 0) {
+    snapshot_fail("not a checkpoint file");
+  }
+  if (snapshot_read_int(file) != sim->processes.count ||
+      (uint64_t)snapshot_read_int(file) != fingerprint(sim)) {
+    snapshot_fail("taken from a different input file or page size");
+  }
+
+  sim->clock = snapshot_read_int(file);
+  sim->next_arrival = snapshot_read_int(file);
+  sim->total_turnaround = snapshot_read_double(file);
+  sim->completed_processes = snapshot_read_int(file);
+  sim->events = snapshot_read_int(file);
+  AdmissionPolicy admission = sim->admission;
+  int64_t saved_admission = snapshot_read_int(file);
+  sim->head_blocked = snapshot_read_int(file);
+  sim->blocked_generation = snapshot_read_int(file);
+  if (sim->next_arrival < 0 || sim->next_arrival > sim->processes.count) {
+    snapshot_fail("arrival cursor out of range");
+  }
+  if (saved_admission != ADMIT_FCFS && saved_admission != ADMIT_BACKFILL) {
+    snapshot_fail("unknown admission policy");
+  }
+  // The retry guard only holds under the policy that set it
+  sim->admission = (AdmissionPolicy)saved_admission;
+  sim_set_admission(sim, admission);
+
+  for (int i = 0; i < sim->processes.count; i++) {
+    sim->processes.start[i] = snapshot_read_int(file);
+  }
+
+  int queued = snapshot_read_int(file);
+  int position = 0;
+  for (int q = 0; q < queued; q++) {
+    int id = snapshot_read_int(file);
+    while (position < sim->next_arrival &&
+           sim->processes.id[sim->arrival_order[position]] != id) {
+      position++;
+    }
+    if (position == sim->next_arrival) {
+      snapshot_fail("queued process has not arrived");
+    }
+    enqueue(&sim->queue, sim->arrival_order[position++]);
+  }
+
+  stats_restore(file, &sim->stats);
+  memory_restore(sim->memory, file);
+}
+
+/**
+ * Releases the processes still waiting in the input queue, the process
+ * table and the arrival order.
+ *
+ * Args:
+ *   sim (Simulator*): Pointer to the simulator.
+ *
+ * Notes:
+ *   - The processes and memory passed to `sim_init` are owned by the caller.
+ */
+void sim_free(Simulator *sim) {
+  while (!is_queue_empty(&sim->queue)) {
+    dequeue(&sim->queue);
+  }
+  process_table_free(&sim->processes);
+  free(sim->arrival_order);
+  sim->arrival_order = NULL;
+}
@@ -0,0 +1,74 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <stdio.h>
+
+#include "memory.h"
+#include "parser.h"
+#include "processtable.h"
+#include "scheduler.h"
+#include "stats.h"
+#include "trace.h"
+
+// Last clock tick simulated by the memory simulator
+#define SIM_END_TIME 100000
+
+// Order in which queued processes are moved into memory
+typedef enum {
+  ADMIT_FCFS,      // Strictly in queue order; a head that does not fit
+                   // holds back every process behind it
+  ADMIT_BACKFILL,  // In queue order, skipping processes that do not fit
+} AdmissionPolicy;
+
+// How much of the text log is written
+typedef enum {
+  OUTPUT_QUIET,      // Nothing
+  OUTPUT_SUMMARY,    // Only the average turnaround time
+  OUTPUT_EVENTS,     // Events and input queues, without memory maps
+  OUTPUT_FULL_MAPS,  // Events, input queues and memory maps
+} OutputLevel;
+
+// State of one run of the memory manager simulation
+typedef struct {
+  ProcessTable processes;     // Processes from the input file, by column
+  Memory *memory;             // Memory the processes are placed in
+  InputQueue queue;           // Processes waiting for memory
+  FILE *out;                  // Where the event log is written
+  TraceWriter *trace;         // Structured records written instead of the
+                              // text log (NULL for the text log)
+  AdmissionPolicy admission;  // How queued processes are admitted
+  OutputLevel output;         // Detail of the text log (ignored for traces)
+
+  int *arrival_order;         // Process indices sorted by arrival time,
+                              // ties in input order
+  int next_arrival;           // Position in `arrival_order` of the next
+                              // process to arrive
+  int clock;                  // Next clock tick to simulate
+  double total_turnaround;    // Sum of turnaround times of completed processes
+  int completed_processes;    // Number of completed processes
+  unsigned long events;       // Arrivals, admissions and completions so far
+  SimStats stats;             // Wait, turnaround, memory and queue statistics
+  int head_blocked;           // 1 if the queue head (every queued process
+                              // with ADMIT_BACKFILL) failed to fit at
+                              // `blocked_generation`
+  unsigned long blocked_generation;  // Free-memory generation of the last
+                                     // failed attempt
+} Simulator;
+
+// Function prototypes
+void sim_init(Simulator *sim, const Process *processes, int num_processes,
+              Memory *memory, FILE *out);
+int parse_admission_policy(const char *name, AdmissionPolicy *policy);
+int parse_output_level(const char *flag, OutputLevel *level);
+const char *admission_policy_name(AdmissionPolicy policy);
+void sim_set_admission(Simulator *sim, AdmissionPolicy policy);
+void sim_add_process(Simulator *sim, const ProcessTable *from, int i);
+void sim_step(Simulator *sim);
+void sim_run(Simulator *sim, int end_time);
+void sim_print_summary(Simulator *sim);
+void sim_print_stats(Simulator *sim, FILE *out, int json);
+void sim_save(Simulator *sim, FILE *file);
+void sim_restore(Simulator *sim, FILE *file);
+void sim_free(Simulator *sim);
+
+#endif
@@ -0,0 +1,77 @@
+#include "snapshot.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Writes an integer in a variable-length encoding.
+ *
+ * Args:
+ *   file (FILE*): Checkpoint being written.
+ *   value (int64_t): Value to write.
+ *
+ * Notes:
+ *   - Values are zigzag encoded (so small negative numbers such as -1 stay
+ * small) and written 7 bits per byte, low bits first, with the top bit of
+ * each byte marking that more bytes follow. Most values take 1 or 2 bytes.
+ */
+void snapshot_write_int(FILE *file, int64_t value) {
+  uint64_t bits = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+  while (bits >= 0x80) {
+    fputc((int)(bits & 0x7f) | 0x80, file);
+    bits >>= 7;
+  }
+  fputc((int)bits, file);
+}
+
+// Writes a double as its raw 64 bits so it round-trips exactly
+void snapshot_write_double(FILE *file, double value) {
+  int64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  snapshot_write_int(file, bits);
+}
+
+/**
+ * Reads an integer written by `snapshot_write_int`.
+ *
+ * Args:
+ *   file (FILE*): Checkpoint being read.
+ *
+ * Returns:
+ *   int64_t: The value read.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the file ends early.
+ */
+int64_t snapshot_read_int(FILE *file) {
+  uint64_t bits = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = fgetc(file);
+    if (byte == EOF) snapshot_fail("truncated");
+    bits |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return (int64_t)(bits >> 1) ^ -(int64_t)(bits & 1);
+    }
+  }
+  snapshot_fail("malformed integer");
+  return 0;
+}
+
+// Reads a double written by `snapshot_write_double`
+double snapshot_read_double(FILE *file) {
+  int64_t bits = snapshot_read_int(file);
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/**
+ * Reports an unusable checkpoint and exits.
+ *
+ * Args:
+ *   what (const char*): What is wrong with the checkpoint.
+ */
+void snapshot_fail(const char *what) {
+  fprintf(stderr, "Error: Cannot restore checkpoint (%s).\n", what);
+  exit(EXIT_FAILURE);
+}
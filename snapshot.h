@@ -0,0 +1,17 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Checkpoint files start with these 8 bytes
+#define SNAPSHOT_MAGIC "MMSNAP03"
+
+// Function prototypes
+void snapshot_write_int(FILE *file, int64_t value);
+void snapshot_write_double(FILE *file, double value);
+int64_t snapshot_read_int(FILE *file);
+double snapshot_read_double(FILE *file);
+void snapshot_fail(const char *what);
+
+#endif
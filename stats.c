@@ -0,0 +1,346 @@
+#include "stats.h"
+
+#include <string.h>
+
+#include "snapshot.h"
+
+// Bucket of a value (negative values count as 0)
+int histogram_bucket_of(int64_t value) {
+  uint64_t v = value > 0 ? (uint64_t)value : 0;
+  if (v < HIST_SUB_BUCKETS) return (int)v;
+  int exponent = 63 - __builtin_clzll(v);
+  return HIST_SUB_BUCKETS + (exponent - 3) * HIST_SUB_BUCKETS +
+         (int)((v >> (exponent - 3)) & (HIST_SUB_BUCKETS - 1));
+}
+
+// Largest value falling into a bucket
+int64_t histogram_bucket_upper(int bucket) {
+  if (bucket < HIST_SUB_BUCKETS) return bucket;
+  int exponent = (bucket - HIST_SUB_BUCKETS) / HIST_SUB_BUCKETS + 3;
+  int mantissa = (bucket - HIST_SUB_BUCKETS) % HIST_SUB_BUCKETS;
+  return ((int64_t)(HIST_SUB_BUCKETS + mantissa + 1) << (exponent - 3)) - 1;
+}
+
+// Empties a histogram
+void histogram_init(Histogram *histogram) {
+  memset(histogram, 0, sizeof(Histogram));
+}
+
+/**
+ * Adds a value to a histogram.
+ *
+ * Args:
+ *   histogram (Histogram*): Histogram to update.
+ *   value (int64_t): Value to record; negative values are recorded as 0.
+ */
+void histogram_record(Histogram *histogram, int64_t value) {
+  if (value < 0) value = 0;
+  if (histogram->count == 0 || value < histogram->min) histogram->min = value;
+  if (value > histogram->max) histogram->max = value;
+  histogram->count++;
+  histogram->sum += value;
+  histogram->buckets[histogram_bucket_of(value)]++;
+}
+
+/**
+ * Adds the values of one histogram to another.
+ *
+ * Args:
+ *   into (Histogram*): Histogram receiving the values.
+ *   from (const Histogram*): Histogram whose values are added.
+ */
+void histogram_merge(Histogram *into, const Histogram *from) {
+  if (from->count == 0) return;
+  if (into->count == 0 || from->min < into->min) into->min = from->min;
+  if (from->max > into->max) into->max = from->max;
+  into->count += from->count;
+  into->sum += from->sum;
+  for (int b = 0; b < HIST_BUCKETS; b++) into->buckets[b] += from->buckets[b];
+}
+
+/**
+ * Estimates a percentile of the recorded values.
+ *
+ * Args:
+ *   histogram (const Histogram*): Histogram to query.
+ *   percent (double): Percentile to estimate, from 0 to 100.
+ *
+ * Returns:
+ *   int64_t: The upper bound of the bucket holding the nearest-rank value,
+ * clamped to the recorded maximum (0 when the histogram is empty).
+ */
+int64_t histogram_percentile(const Histogram *histogram, double percent) {
+  if (histogram->count == 0) return 0;
+  uint64_t rank = (uint64_t)(histogram->count * percent / 100.0 + 0.999999);
+  if (rank == 0) rank = 1;
+
+  uint64_t seen = 0;
+  for (int b = 0; b < HIST_BUCKETS; b++) {
+    seen += histogram->buckets[b];
+    if (seen >= rank) {
+      int64_t upper = histogram_bucket_upper(b);
+      return upper < histogram->max ? upper : histogram->max;
+    }
+  }
+  return histogram->max;
+}
+
+// Starts accumulating a value that is `value` from time `start` on
+void time_weighted_init(TimeWeighted *tw, int64_t start, int64_t value) {
+  tw->area = 0;
+  tw->duration = 0;
+  tw->value = value;
+  tw->since = start;
+  tw->min = value;
+  tw->max = value;
+}
+
+/**
+ * Changes a time-weighted value.
+ *
+ * Args:
+ *   tw (TimeWeighted*): Accumulator to update.
+ *   time (int64_t): Time of the change; never earlier than the last change.
+ *   value (int64_t): Value from `time` on.
+ */
+void time_weighted_set(TimeWeighted *tw, int64_t time, int64_t value) {
+  tw->area += (double)tw->value * (time - tw->since);
+  tw->duration += time - tw->since;
+  tw->since = time;
+  tw->value = value;
+  if (value < tw->min) tw->min = value;
+  if (value > tw->max) tw->max = value;
+}
+
+/**
+ * Starts collecting statistics for a run.
+ *
+ * Args:
+ *   stats (SimStats*): Statistics to initialize.
+ *   total_pages (int64_t): Pages of memory, used for utilization.
+ *
+ * Notes:
+ *   - Every accumulator has a fixed size, however many processes are run.
+ *   - The run starts at time 0 with memory entirely free and no process
+ * queued.
+ */
+void stats_init(SimStats *stats, int64_t total_pages) {
+  histogram_init(&stats->wait);
+  histogram_init(&stats->turnaround);
+  time_weighted_init(&stats->memory_used, 0, 0);
+  time_weighted_init(&stats->free_runs, 0, total_pages > 0);
+  time_weighted_init(&stats->largest_free_run, 0, total_pages);
+  time_weighted_init(&stats->queue_length, 0, 0);
+  stats->capacity_area = 0;
+  stats->total_pages = total_pages;
+}
+
+/**
+ * Closes the time-weighted metrics of a run at its end time.
+ *
+ * Args:
+ *   stats (SimStats*): Statistics of the run.
+ *   end_time (int64_t): Time the run ended.
+ *
+ * Notes:
+ *   - Call this on each run's statistics before merging them, not on the
+ * merged result.
+ */
+void stats_finish(SimStats *stats, int64_t end_time) {
+  time_weighted_set(&stats->memory_used, end_time, stats->memory_used.value);
+  time_weighted_set(&stats->free_runs, end_time, stats->free_runs.value);
+  time_weighted_set(&stats->largest_free_run, end_time,
+                    stats->largest_free_run.value);
+  time_weighted_set(&stats->queue_length, end_time,
+                    stats->queue_length.value);
+  stats->capacity_area =
+      (double)stats->total_pages * stats->memory_used.duration;
+}
+
+static void merge_time_weighted(TimeWeighted *into, const TimeWeighted *from) {
+  into->area += from->area;
+  into->duration += from->duration;
+  if (from->min < into->min) into->min = from->min;
+  if (from->max > into->max) into->max = from->max;
+}
+
+/**
+ * Adds the statistics of a finished run to another, as if the runs were one.
+ *
+ * Args:
+ *   into (SimStats*): Statistics receiving the run.
+ *   from (const SimStats*): Statistics of a run closed with `stats_finish`.
+ *
+ * Notes:
+ *   - Time-weighted means of the result weight each run by its duration,
+ * and utilization by its memory size times its duration.
+ */
+void stats_merge(SimStats *into, const SimStats *from) {
+  histogram_merge(&into->wait, &from->wait);
+  histogram_merge(&into->turnaround, &from->turnaround);
+  merge_time_weighted(&into->memory_used, &from->memory_used);
+  merge_time_weighted(&into->free_runs, &from->free_runs);
+  merge_time_weighted(&into->largest_free_run, &from->largest_free_run);
+  merge_time_weighted(&into->queue_length, &from->queue_length);
+  into->capacity_area += from->capacity_area;
+}
+
+static void save_histogram(FILE *file, const Histogram *h) {
+  snapshot_write_int(file, h->count);
+  snapshot_write_double(file, h->sum);
+  snapshot_write_int(file, h->min);
+  snapshot_write_int(file, h->max);
+  for (int b = 0; b < HIST_BUCKETS; b++) {
+    snapshot_write_int(file, h->buckets[b]);
+  }
+}
+
+static void restore_histogram(FILE *file, Histogram *h) {
+  h->count = snapshot_read_int(file);
+  h->sum = snapshot_read_double(file);
+  h->min = snapshot_read_int(file);
+  h->max = snapshot_read_int(file);
+  for (int b = 0; b < HIST_BUCKETS; b++) {
+    h->buckets[b] = snapshot_read_int(file);
+  }
+}
+
+static void save_time_weighted(FILE *file, const TimeWeighted *tw) {
+  snapshot_write_double(file, tw->area);
+  snapshot_write_double(file, tw->duration);
+  snapshot_write_int(file, tw->value);
+  snapshot_write_int(file, tw->since);
+  snapshot_write_int(file, tw->min);
+  snapshot_write_int(file, tw->max);
+}
+
+static void restore_time_weighted(FILE *file, TimeWeighted *tw) {
+  tw->area = snapshot_read_double(file);
+  tw->duration = snapshot_read_double(file);
+  tw->value = snapshot_read_int(file);
+  tw->since = snapshot_read_int(file);
+  tw->min = snapshot_read_int(file);
+  tw->max = snapshot_read_int(file);
+}
+
+/**
+ * Writes statistics to a checkpoint.
+ *
+ * Args:
+ *   file (FILE*): Checkpoint being written.
+ *   stats (const SimStats*): Statistics of the run so far.
+ */
+void stats_save(FILE *file, const SimStats *stats) {
+  save_histogram(file, &stats->wait);
+  save_histogram(file, &stats->turnaround);
+  save_time_weighted(file, &stats->memory_used);
+  save_time_weighted(file, &stats->free_runs);
+  save_time_weighted(file, &stats->largest_free_run);
+  save_time_weighted(file, &stats->queue_length);
+  snapshot_write_double(file, stats->capacity_area);
+  snapshot_write_int(file, stats->total_pages);
+}
+
+/**
+ * Reads statistics written by `stats_save`.
+ *
+ * Args:
+ *   file (FILE*): Checkpoint positioned at the statistics.
+ *   stats (SimStats*): Receives the statistics.
+ */
+void stats_restore(FILE *file, SimStats *stats) {
+  restore_histogram(file, &stats->wait);
+  restore_histogram(file, &stats->turnaround);
+  restore_time_weighted(file, &stats->memory_used);
+  restore_time_weighted(file, &stats->free_runs);
+  restore_time_weighted(file, &stats->largest_free_run);
+  restore_time_weighted(file, &stats->queue_length);
+  stats->capacity_area = snapshot_read_double(file);
+  stats->total_pages = snapshot_read_int(file);
+}
+
+static double histogram_mean(const Histogram *histogram) {
+  return histogram->count ? histogram->sum / histogram->count : 0;
+}
+
+static double time_weighted_mean(const TimeWeighted *tw) {
+  return tw->duration > 0 ? tw->area / tw->duration : 0;
+}
+
+static void print_histogram_json(FILE *out, const char *name,
+                                 const Histogram *h) {
+  fprintf(out,
+          "\"%s\": {\"count\": %llu, \"mean\": %.2f, \"min\": %lld, "
+          "\"p50\": %lld, \"p90\": %lld, \"p99\": %lld, \"max\": %lld}",
+          name, (unsigned long long)h->count, histogram_mean(h),
+          (long long)h->min, (long long)histogram_percentile(h, 50),
+          (long long)histogram_percentile(h, 90),
+          (long long)histogram_percentile(h, 99), (long long)h->max);
+}
+
+static void print_histogram_text(FILE *out, const char *name,
+                                 const Histogram *h) {
+  fprintf(out,
+          "  %-12s count %llu, mean %.2f, min %lld, p50 %lld, p90 %lld, "
+          "p99 %lld, max %lld\n",
+          name, (unsigned long long)h->count, histogram_mean(h),
+          (long long)h->min, (long long)histogram_percentile(h, 50),
+          (long long)histogram_percentile(h, 90),
+          (long long)histogram_percentile(h, 99), (long long)h->max);
+}
+
+/**
+ * Prints the statistics of finished runs.
+ *
+ * Args:
+ *   out (FILE*): Stream to print to.
+ *   stats (const SimStats*): Statistics closed with `stats_finish`.
+ *   json (int): 1 for a single JSON object, 0 for a readable summary block.
+ *
+ * Notes:
+ *   - Percentiles are histogram bucket bounds, within 12.5% of the exact
+ * value; counts, means, minimums and maximums are exact.
+ */
+void print_stats(FILE *out, const SimStats *stats, int json) {
+  double utilization =
+      stats->capacity_area > 0 ? stats->memory_used.area / stats->capacity_area
+                               : 0;
+
+  if (json) {
+    fprintf(out, "{");
+    print_histogram_json(out, "wait", &stats->wait);
+    fprintf(out, ", ");
+    print_histogram_json(out, "turnaround", &stats->turnaround);
+    fprintf(out,
+            ", \"memory_used\": {\"mean\": %.2f, \"max\": %lld, "
+            "\"utilization\": %.4f}, "
+            "\"free_runs\": {\"mean\": %.2f, \"max\": %lld}, "
+            "\"largest_free_run\": {\"mean\": %.2f, \"min\": %lld}, "
+            "\"queue_length\": {\"mean\": %.4f, \"max\": %lld}}\n",
+            time_weighted_mean(&stats->memory_used),
+            (long long)stats->memory_used.max, utilization,
+            time_weighted_mean(&stats->free_runs),
+            (long long)stats->free_runs.max,
+            time_weighted_mean(&stats->largest_free_run),
+            (long long)stats->largest_free_run.min,
+            time_weighted_mean(&stats->queue_length),
+            (long long)stats->queue_length.max);
+    return;
+  }
+
+  fprintf(out, "Statistics:\n");
+  print_histogram_text(out, "wait", &stats->wait);
+  print_histogram_text(out, "turnaround", &stats->turnaround);
+  fprintf(out, "  %-12s mean %.2f pages, max %lld, utilization %.2f%%\n",
+          "memory used", time_weighted_mean(&stats->memory_used),
+          (long long)stats->memory_used.max, utilization * 100);
+  fprintf(out, "  %-12s mean %.2f, max %lld\n", "free runs",
+          time_weighted_mean(&stats->free_runs),
+          (long long)stats->free_runs.max);
+  fprintf(out, "  %-12s mean %.2f pages, min %lld\n", "largest free",
+          time_weighted_mean(&stats->largest_free_run),
+          (long long)stats->largest_free_run.min);
+  fprintf(out, "  %-12s mean %.4f, max %lld\n", "queue length",
+          time_weighted_mean(&stats->queue_length),
+          (long long)stats->queue_length.max);
+}
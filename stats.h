@@ -0,0 +1,60 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+// Log-linear histogram: values below HIST_SUB_BUCKETS are exact, larger ones
+// fall into HIST_SUB_BUCKETS buckets per power of two (within 12.5%)
+#define HIST_SUB_BUCKETS 8
+#define HIST_BUCKETS (HIST_SUB_BUCKETS + 61 * HIST_SUB_BUCKETS)
+
+// Fixed-size distribution of non-negative values; histograms of separate
+// runs merge exactly by adding them
+typedef struct {
+  uint64_t count;                  // Number of values recorded
+  double sum;                      // Sum of the values
+  int64_t min;                     // Smallest value (0 when empty)
+  int64_t max;                     // Largest value (0 when empty)
+  uint64_t buckets[HIST_BUCKETS];  // Number of values per bucket
+} Histogram;
+
+// Time integral of a piecewise-constant value, such as the queue length
+typedef struct {
+  double area;      // Integral of the value over the finished intervals
+  double duration;  // Length of the finished intervals
+  int64_t value;    // Current value
+  int64_t since;    // Time the current value was set
+  int64_t min;      // Smallest value seen
+  int64_t max;      // Largest value seen
+} TimeWeighted;
+
+// Summary statistics of one or more simulation runs
+typedef struct {
+  Histogram wait;                 // Ticks from arrival to admission
+  Histogram turnaround;           // Ticks from arrival to completion
+  TimeWeighted memory_used;       // Frames held by resident processes
+  TimeWeighted free_runs;         // Maximal runs of free frames
+  TimeWeighted largest_free_run;  // Frames in the longest free run
+  TimeWeighted queue_length;      // Processes in the input queue
+  double capacity_area;           // Total pages times the finished duration
+  int64_t total_pages;            // Pages of memory in the current run
+} SimStats;
+
+// Function prototypes
+int histogram_bucket_of(int64_t value);
+int64_t histogram_bucket_upper(int bucket);
+void histogram_init(Histogram *histogram);
+void histogram_record(Histogram *histogram, int64_t value);
+void histogram_merge(Histogram *into, const Histogram *from);
+int64_t histogram_percentile(const Histogram *histogram, double percent);
+void time_weighted_init(TimeWeighted *tw, int64_t start, int64_t value);
+void time_weighted_set(TimeWeighted *tw, int64_t time, int64_t value);
+void stats_init(SimStats *stats, int64_t total_pages);
+void stats_finish(SimStats *stats, int64_t end_time);
+void stats_merge(SimStats *into, const SimStats *from);
+void stats_save(FILE *file, const SimStats *stats);
+void stats_restore(FILE *file, SimStats *stats);
+void print_stats(FILE *out, const SimStats *stats, int json);
+
+#endif
@@ -0,0 +1,164 @@
+#define _GNU_SOURCE
+
+#include "timing.h"
+
+#ifdef SIM_TIMING
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "stats.h"
+
+// Accumulators owned by one thread, merged when the report is printed
+typedef struct TimerSet {
+  Histogram timers[NUM_TIMERS];  // Intervals recorded per timer, in ticks
+  struct TimerSet *next;         // Next thread's accumulators
+} TimerSet;
+
+static const char *kTimerNames[NUM_TIMERS] = {
+    "parse",    "arrival",    "completion", "admission",
+    "allocate", "deallocate", "memory map", "output",
+};
+
+static _Thread_local TimerSet *thread_set;
+static TimerSet *all_sets;
+static pthread_mutex_t sets_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Reference points for converting timer ticks to nanoseconds
+static uint64_t base_ticks;
+static double base_ns;
+
+static double monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Reads the timer.
+ *
+ * Returns:
+ *   uint64_t: The time stamp counter on x86, nanoseconds elsewhere. Only
+ * differences between readings are meaningful.
+ */
+uint64_t timing_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+__attribute__((constructor)) static void calibrate(void) {
+  base_ns = monotonic_ns();
+  base_ticks = timing_now();
+}
+
+/**
+ * Records one timed interval in the calling thread's accumulators.
+ *
+ * Args:
+ *   kind (TimerKind): What was timed.
+ *   elapsed (uint64_t): Difference of two `timing_now` readings.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the thread's accumulators
+ * cannot be allocated.
+ */
+void timing_record(TimerKind kind, uint64_t elapsed) {
+  TimerSet *set = thread_set;
+  if (!set) {
+    set = calloc(1, sizeof(TimerSet));
+    if (!set) {
+      perror("Error allocating memory for timers");
+      exit(EXIT_FAILURE);
+    }
+    pthread_mutex_lock(&sets_lock);
+    set->next = all_sets;
+    all_sets = set;
+    pthread_mutex_unlock(&sets_lock);
+    thread_set = set;
+  }
+
+  histogram_record(&set->timers[kind], (int64_t)elapsed);
+}
+
+// Forwards writes to the wrapped stream, timing each one
+static ssize_t timed_write(void *cookie, const char *buffer, size_t size) {
+  TIMER_START(start);
+  size_t written = fwrite(buffer, 1, size, (FILE *)cookie);
+  fflush((FILE *)cookie);
+  TIMER_STOP(TIMER_OUTPUT, start);
+  return written;
+}
+
+/**
+ * Wraps a stream so that the time spent writing to it is recorded as output.
+ *
+ * Args:
+ *   inner (FILE*): Stream the bytes are forwarded to.
+ *
+ * Returns:
+ *   FILE*: A buffered stream to format output into. Closing it flushes it but
+ * leaves `inner` open.
+ *
+ * Errors:
+ *   - Exits the program with an error message if the stream cannot be
+ * created.
+ */
+FILE *timing_wrap_stream(FILE *inner) {
+  cookie_io_functions_t functions = {NULL, timed_write, NULL, NULL};
+  FILE *stream = fopencookie(inner, "w", functions);
+  if (!stream) {
+    perror("Error opening timed stream");
+    exit(EXIT_FAILURE);
+  }
+  return stream;
+}
+
+/**
+ * Prints count, total, mean, p50, p99 and max per timer, merged over threads.
+ *
+ * Args:
+ *   out (FILE*): Stream to print to.
+ *
+ * Notes:
+ *   - Percentiles are bucket upper bounds, so they overestimate by at most
+ * 12.5%.
+ */
+void print_timing(FILE *out) {
+  double ns_per_tick = 1.0;
+  uint64_t ticks = timing_now() - base_ticks;
+  if (ticks > 0) ns_per_tick = (monotonic_ns() - base_ns) / ticks;
+
+  static Histogram merged;
+  fprintf(out, "Timing:%*s%10s %12s %10s %10s %10s %10s\n", 5, "", "count",
+          "total ms", "mean ns", "p50 ns", "p99 ns", "max ns");
+
+  pthread_mutex_lock(&sets_lock);
+  for (int kind = 0; kind < NUM_TIMERS; kind++) {
+    histogram_init(&merged);
+    for (TimerSet *set = all_sets; set; set = set->next) {
+      histogram_merge(&merged, &set->timers[kind]);
+    }
+    if (merged.count == 0) continue;
+
+    double total = merged.sum * ns_per_tick;
+    fprintf(out, "  %-10s %10llu %12.3f %10.0f %10.0f %10.0f %10.0f\n",
+            kTimerNames[kind], (unsigned long long)merged.count, total / 1e6,
+            total / merged.count,
+            histogram_percentile(&merged, 50) * ns_per_tick,
+            histogram_percentile(&merged, 99) * ns_per_tick,
+            merged.max * ns_per_tick);
+  }
+  pthread_mutex_unlock(&sets_lock);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdio.h>
+
+// Phases and events timed by the timing subsystem
+typedef enum {
+  TIMER_PARSE,       // parse_input_file plus page demand
+  TIMER_ARRIVAL,     // One arrival event, including its log lines
+  TIMER_COMPLETION,  // One completion event, including its memory map
+  TIMER_ADMISSION,   // One admission event once placed, including its
+                     // memory map (placement is TIMER_ALLOCATE)
+  TIMER_ALLOCATE,    // One allocate_memory call (successful or not) or
+                     // allocate_memory_batch call
+  TIMER_DEALLOCATE,  // One deallocate_memory call
+  TIMER_MEMORY_MAP,  // One print_memory_map call
+  TIMER_OUTPUT,      // One write of buffered output to the real stream
+  NUM_TIMERS
+} TimerKind;
+
+// Per-phase timing, compiled in only when SIM_TIMING is defined (make
+// TIMING=1). Otherwise the TIMER_* macros expand to nothing.
+#ifdef SIM_TIMING
+
+#include <stdint.h>
+
+uint64_t timing_now(void);
+void timing_record(TimerKind kind, uint64_t elapsed);
+FILE *timing_wrap_stream(FILE *inner);
+void print_timing(FILE *out);
+
+#define TIMER_START(name) uint64_t name = timing_now()
+#define TIMER_STOP(kind, name) timing_record((kind), timing_now() - (name))
+
+#else
+
+#define TIMER_START(name) ((void)0)
+#define TIMER_STOP(kind, name) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,201 @@
+#include "trace.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Size of the record buffer; flushed once less than a record's worth is left
+#define TRACE_BUFFER_SIZE (64 * 1024)
+#define TRACE_MAX_RECORD 128
+
+static const char *kEventNames[] = {"arrival", "admission", "completion",
+                                    "alloc", "free"};
+
+/**
+ * Looks up a trace format by its command-line name.
+ *
+ * Args:
+ *   name (const char*): "jsonl", "csv" or "binary".
+ *   format (TraceFormat*): Set to the matching format.
+ *
+ * Returns:
+ *   int: 1 if `name` is a known format, 0 otherwise.
+ */
+int parse_trace_format(const char *name, TraceFormat *format) {
+  if (strcmp(name, "jsonl") == 0) {
+    *format = TRACE_JSONL;
+  } else if (strcmp(name, "csv") == 0) {
+    *format = TRACE_CSV;
+  } else if (strcmp(name, "binary") == 0) {
+    *format = TRACE_BINARY;
+  } else {
+    return 0;
+  }
+  return 1;
+}
+
+// Writes the buffered records of a binary trace as one block of columns
+static void flush_block(TraceWriter *trace) {
+  static const char padding[4] = {0};
+  uint32_t count = trace->used;
+  size_t column = TRACE_BLOCK_RECORDS * sizeof(int32_t);
+
+  fwrite(&count, sizeof(count), 1, trace->out);
+  for (int i = 0; i < 4; i++) {
+    fwrite(trace->buffer + i * column, sizeof(int32_t), count, trace->out);
+  }
+  fwrite(trace->buffer + 4 * column, sizeof(uint8_t), count, trace->out);
+  fwrite(padding, 1, (4 - count % 4) % 4, trace->out);
+  trace->used = 0;
+}
+
+static void flush_buffer(TraceWriter *trace) {
+  if (trace->used == 0) return;
+  if (trace->format == TRACE_BINARY) {
+    flush_block(trace);
+  } else {
+    fwrite(trace->buffer, 1, trace->used, trace->out);
+    trace->used = 0;
+  }
+}
+
+static void put_string(TraceWriter *trace, const char *text) {
+  size_t length = strlen(text);
+  memcpy(trace->buffer + trace->used, text, length);
+  trace->used += length;
+}
+
+// Appends a decimal integer without going through printf
+static void put_int(TraceWriter *trace, int value) {
+  char digits[12];
+  int count = 0;
+  unsigned magnitude = value < 0 ? 0u - (unsigned)value : (unsigned)value;
+  do {
+    digits[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude > 0);
+  if (value < 0) trace->buffer[trace->used++] = '-';
+  while (count > 0) trace->buffer[trace->used++] = digits[--count];
+}
+
+/**
+ * Starts a trace.
+ *
+ * Args:
+ *   trace (TraceWriter*): Writer to initialize.
+ *   out (FILE*): Stream the records are written to.
+ *   format (TraceFormat): Record format.
+ *
+ * Behavior:
+ *   - Buffers the CSV header line when `format` is TRACE_CSV, or writes the
+ * file magic when it is TRACE_BINARY.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+void trace_open(TraceWriter *trace, FILE *out, TraceFormat format) {
+  trace->out = out;
+  trace->format = format;
+  trace->used = 0;
+  trace->capacity = format == TRACE_BINARY
+                        ? TRACE_BLOCK_RECORDS * TRACE_RECORD_BYTES
+                        : TRACE_BUFFER_SIZE;
+  trace->buffer = malloc(trace->capacity);
+  if (!trace->buffer) {
+    perror("Error allocating memory for trace buffer");
+    exit(EXIT_FAILURE);
+  }
+
+  if (format == TRACE_CSV) {
+    put_string(trace, "time,event,pid,frame_start,frame_len\n");
+  } else if (format == TRACE_BINARY) {
+    fwrite(TRACE_MAGIC, 1, strlen(TRACE_MAGIC), out);
+  }
+}
+
+// Stores a record in the columns of the current binary block
+static void put_record(TraceWriter *trace, EventType type, int time, int pid,
+                       int frame_start, int frame_len) {
+  int32_t *columns = (int32_t *)trace->buffer;
+  size_t row = trace->used++;
+  columns[row] = time;
+  columns[TRACE_BLOCK_RECORDS + row] = pid;
+  columns[2 * TRACE_BLOCK_RECORDS + row] = frame_start;
+  columns[3 * TRACE_BLOCK_RECORDS + row] = frame_len;
+  ((uint8_t *)(columns + 4 * TRACE_BLOCK_RECORDS))[row] = type;
+  if (trace->used == TRACE_BLOCK_RECORDS) flush_block(trace);
+}
+
+/**
+ * Appends one record to the trace.
+ *
+ * Args:
+ *   trace (TraceWriter*): Writer from `trace_open`.
+ *   type (EventType): Kind of record.
+ *   time (int): Clock tick of the event.
+ *   pid (int): Process the event concerns.
+ *   frame_start (int): First frame of the range (EVENT_ALLOC/EVENT_FREE).
+ *   frame_len (int): Number of frames in the range (EVENT_ALLOC/EVENT_FREE).
+ *
+ * Notes:
+ *   - `frame_start` and `frame_len` are ignored for the other record types;
+ * JSON records then omit them, CSV rows leave them empty and binary records
+ * store them as 0.
+ */
+void trace_event(TraceWriter *trace, EventType type, int time, int pid,
+                 int frame_start, int frame_len) {
+  int has_frames = type == EVENT_ALLOC || type == EVENT_FREE;
+  if (trace->format == TRACE_BINARY) {
+    put_record(trace, type, time, pid, has_frames ? frame_start : 0,
+               has_frames ? frame_len : 0);
+    return;
+  }
+
+  if (trace->capacity - trace->used < TRACE_MAX_RECORD) flush_buffer(trace);
+
+  if (trace->format == TRACE_JSONL) {
+    put_string(trace, "{\"t\":");
+    put_int(trace, time);
+    put_string(trace, ",\"event\":\"");
+    put_string(trace, kEventNames[type]);
+    put_string(trace, "\",\"pid\":");
+    put_int(trace, pid);
+    if (has_frames) {
+      put_string(trace, ",\"frame_start\":");
+      put_int(trace, frame_start);
+      put_string(trace, ",\"frame_len\":");
+      put_int(trace, frame_len);
+    }
+    put_string(trace, "}\n");
+  } else {
+    put_int(trace, time);
+    put_string(trace, ",");
+    put_string(trace, kEventNames[type]);
+    put_string(trace, ",");
+    put_int(trace, pid);
+    put_string(trace, ",");
+    if (has_frames) {
+      put_int(trace, frame_start);
+      put_string(trace, ",");
+      put_int(trace, frame_len);
+    } else {
+      put_string(trace, ",");
+    }
+    put_string(trace, "\n");
+  }
+}
+
+/**
+ * Writes out any buffered records and releases the writer's buffer.
+ *
+ * Args:
+ *   trace (TraceWriter*): Writer from `trace_open`.
+ *
+ * Notes:
+ *   - The stream passed to `trace_open` is left open.
+ */
+void trace_close(TraceWriter *trace) {
+  flush_buffer(trace);
+  free(trace->buffer);
+  trace->buffer = NULL;
+}
@@ -0,0 +1,53 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Record formats of the structured event trace
+typedef enum {
+  TRACE_JSONL,   // One JSON object per line
+  TRACE_CSV,     // Header line, then one comma-separated row per record
+  TRACE_BINARY,  // Column blocks of fixed-width fields, see below
+} TraceFormat;
+
+// Binary trace layout (native byte order). The file starts with the 8 bytes
+// of TRACE_MAGIC followed by a sequence of blocks. Each block holds up to
+// TRACE_BLOCK_RECORDS records as a uint32_t record count n and then the
+// columns: int32_t time[n], pid[n], frame_start[n], frame_len[n], then
+// uint8_t type[n] (an EventType) padded with zeros to a multiple of 4 bytes.
+// Every block but the last is full.
+#define TRACE_MAGIC "MMTRACE1"
+#define TRACE_BLOCK_RECORDS 4096
+#define TRACE_RECORD_BYTES (4 * sizeof(int32_t) + sizeof(uint8_t))
+
+// Kinds of trace records
+typedef enum {
+  EVENT_ARRIVAL,     // Process joins the input queue
+  EVENT_ADMISSION,   // Process is moved into memory
+  EVENT_COMPLETION,  // Process finishes and leaves memory
+  EVENT_ALLOC,       // Frames [frame_start, frame_start + frame_len) taken
+  EVENT_FREE,        // Frames [frame_start, frame_start + frame_len) released
+} EventType;
+
+// Buffered writer of trace records. Records are formatted straight into
+// `buffer` and handed to `out` in large writes.
+typedef struct {
+  FILE *out;           // Stream the records are written to
+  TraceFormat format;  // Record format
+  char *buffer;        // Formatted records not yet written (for
+                       // TRACE_BINARY, the columns of the current block)
+  size_t used;         // Bytes of `buffer` in use (for TRACE_BINARY, records
+                       // in the current block)
+  size_t capacity;     // Size of `buffer`
+} TraceWriter;
+
+// Function prototypes
+int parse_trace_format(const char *name, TraceFormat *format);
+void trace_open(TraceWriter *trace, FILE *out, TraceFormat format);
+void trace_event(TraceWriter *trace, EventType type, int time, int pid,
+                 int frame_start, int frame_len);
+void trace_close(TraceWriter *trace);
+
+#endif
@@ -0,0 +1,218 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace.h"
+
+static const char *kEventNames[] = {"arrival", "admission", "completion",
+                                    "alloc", "free"};
+
+// Column views of one block of a mapped binary trace
+typedef struct {
+  uint32_t count;
+  const int32_t *time;
+  const int32_t *pid;
+  const int32_t *frame_start;
+  const int32_t *frame_len;
+  const uint8_t *type;
+} Block;
+
+// Arrival times by process ID, grown as larger IDs are seen
+typedef struct {
+  int *arrival;
+  int capacity;
+} ArrivalTable;
+
+/**
+ * Locates the block starting at `offset` in a mapped binary trace.
+ *
+ * Args:
+ *   data (const char*): Start of the mapping.
+ *   size (size_t): Size of the mapping in bytes.
+ *   offset (size_t): Offset of the block; 4-byte aligned.
+ *   block (Block*): Set to the block's columns.
+ *
+ * Returns:
+ *   size_t: Offset of the next block, or 0 if the block is truncated or
+ * malformed.
+ */
+static size_t read_block(const char *data, size_t size, size_t offset,
+                         Block *block) {
+  if (size - offset < sizeof(uint32_t)) return 0;
+  memcpy(&block->count, data + offset, sizeof(uint32_t));
+  uint32_t n = block->count;
+  size_t column = n * sizeof(int32_t);
+  size_t bytes = sizeof(uint32_t) + 4 * column + (n + 3) / 4 * 4;
+  if (n == 0 || n > TRACE_BLOCK_RECORDS || size - offset < bytes) return 0;
+
+  const int32_t *columns = (const int32_t *)(data + offset + sizeof(uint32_t));
+  block->time = columns;
+  block->pid = columns + n;
+  block->frame_start = columns + 2 * n;
+  block->frame_len = columns + 3 * n;
+  block->type = (const uint8_t *)(columns + 4 * n);
+  for (uint32_t i = 0; i < n; i++) {
+    if (block->type[i] > EVENT_FREE) return 0;
+  }
+  return offset + bytes;
+}
+
+// Prints a block as rows in the --trace=csv format
+static void print_block(const Block *block) {
+  for (uint32_t i = 0; i < block->count; i++) {
+    int type = block->type[i];
+    printf("%d,%s,%d,", block->time[i], kEventNames[type], block->pid[i]);
+    if (type == EVENT_ALLOC || type == EVENT_FREE) {
+      printf("%d,%d\n", block->frame_start[i], block->frame_len[i]);
+    } else {
+      printf(",\n");
+    }
+  }
+}
+
+static void record_arrival(ArrivalTable *table, int pid, int time) {
+  if (pid < 0) return;
+  if (pid >= table->capacity) {
+    int capacity = table->capacity ? table->capacity : 64;
+    while (capacity <= pid) capacity *= 2;
+    int *arrival = realloc(table->arrival, capacity * sizeof(int));
+    if (!arrival) {
+      perror("Error allocating memory for arrival times");
+      exit(EXIT_FAILURE);
+    }
+    for (int i = table->capacity; i < capacity; i++) arrival[i] = -1;
+    table->arrival = arrival;
+    table->capacity = capacity;
+  }
+  table->arrival[pid] = time;
+}
+
+static int compare_ints(const void *a, const void *b) {
+  int x = *(const int *)a, y = *(const int *)b;
+  return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted values
+static int percentile(const int *sorted, size_t count, int p) {
+  size_t rank = (count * p + 99) / 100;
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void print_turnaround(int *turnaround, size_t count) {
+  if (count == 0) {
+    printf("No processes completed.\n");
+    return;
+  }
+  qsort(turnaround, count, sizeof(int), compare_ints);
+  double total = 0;
+  for (size_t i = 0; i < count; i++) total += turnaround[i];
+
+  printf("Turnaround: %zu completed\n", count);
+  printf("  mean %.2f\n", total / count);
+  printf("  min %d\n", turnaround[0]);
+  printf("  p50 %d\n", percentile(turnaround, count, 50));
+  printf("  p90 %d\n", percentile(turnaround, count, 90));
+  printf("  p99 %d\n", percentile(turnaround, count, 99));
+  printf("  max %d\n", turnaround[count - 1]);
+}
+
+/**
+ * Reads a binary trace written with --trace=binary.
+ *
+ * Usage:
+ *   memory_trace <trace_file> [--turnaround]
+ *
+ * Behavior:
+ *   - Maps the trace and walks it block by block, reading columns in place.
+ *   - Prints every record in the --trace=csv format, or with --turnaround
+ * prints the distribution of completion minus arrival time per process.
+ */
+int main(int argc, char *argv[]) {
+  if (argc < 2 || argc > 3 ||
+      (argc == 3 && strcmp(argv[2], "--turnaround") != 0)) {
+    fprintf(stderr, "Usage: %s <trace_file> [--turnaround]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  int turnaround_only = argc == 3;
+
+  int fd = open(argv[1], O_RDONLY);
+  if (fd == -1) {
+    perror("Error opening trace file");
+    return EXIT_FAILURE;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    perror("Error reading trace file");
+    return EXIT_FAILURE;
+  }
+  size_t size = st.st_size;
+  size_t magic = strlen(TRACE_MAGIC);
+  if (size < magic) {
+    fprintf(stderr, "Error: %s is not a binary trace.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+  const char *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    perror("Error mapping trace file");
+    return EXIT_FAILURE;
+  }
+  close(fd);
+  if (memcmp(data, TRACE_MAGIC, magic) != 0) {
+    fprintf(stderr, "Error: %s is not a binary trace.\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  ArrivalTable arrivals = {NULL, 0};
+  int *turnaround = NULL;
+  size_t completed = 0, turnaround_capacity = 0;
+
+  if (!turnaround_only) printf("time,event,pid,frame_start,frame_len\n");
+  size_t offset = magic;
+  while (offset < size) {
+    Block block;
+    size_t next = read_block(data, size, offset, &block);
+    if (next == 0) {
+      fprintf(stderr, "Error: Malformed block at byte %zu of %s.\n", offset,
+              argv[1]);
+      return EXIT_FAILURE;
+    }
+    offset = next;
+
+    if (!turnaround_only) {
+      print_block(&block);
+      continue;
+    }
+    for (uint32_t i = 0; i < block.count; i++) {
+      int pid = block.pid[i];
+      if (block.type[i] == EVENT_ARRIVAL) {
+        record_arrival(&arrivals, pid, block.time[i]);
+      } else if (block.type[i] == EVENT_COMPLETION && pid >= 0 &&
+                 pid < arrivals.capacity && arrivals.arrival[pid] != -1) {
+        if (completed == turnaround_capacity) {
+          turnaround_capacity =
+              turnaround_capacity ? 2 * turnaround_capacity : 1024;
+          turnaround = realloc(turnaround, turnaround_capacity * sizeof(int));
+          if (!turnaround) {
+            perror("Error allocating memory for turnaround times");
+            return EXIT_FAILURE;
+          }
+        }
+        turnaround[completed++] = block.time[i] - arrivals.arrival[pid];
+      }
+    }
+  }
+
+  if (turnaround_only) print_turnaround(turnaround, completed);
+
+  munmap((void *)data, size);
+  free(arrivals.arrival);
+  free(turnaround);
+  return EXIT_SUCCESS;
+}
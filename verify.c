@@ -0,0 +1,435 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "branch.h"
+#include "memory.h"
+#include "parser.h"
+#include "simulator.h"
+#include "workload.h"
+
+// Placement configurations checked against the reference model
+typedef struct {
+  const char *name;
+  const char *flags;  // Equivalent memory_simulator options
+  int extents;
+  int compact;
+  int maps;  // Whether the log has memory maps (0 runs with --events)
+  int backfill_after;  // Tick after which a what-if branch takes over with
+                       // backfill admission (-1 for none)
+} Config;
+
+static const Config kConfigs[] = {
+    {"paging", "", 0, 0, 1, -1},
+    {"paging-extents", " --extents", 1, 0, 1, -1},
+    {"paging-compact", " --compact", 0, 1, 1, -1},
+    {"paging-events", " --events", 0, 0, 0, -1},
+    {"what-if-backfill", " --what-if=100", 0, 0, 1, 100},
+};
+#define NUM_CONFIGS ((int)(sizeof(kConfigs) / sizeof(kConfigs[0])))
+
+// Page sizes tried for random workloads (memory is always 2000 KB)
+static const int kPageSizes[] = {50, 100, 200, 250, 400, 500};
+#define NUM_PAGE_SIZES ((int)(sizeof(kPageSizes) / sizeof(kPageSizes[0])))
+#define TOTAL_MEMORY 2000
+
+// Memory map of the reference model: frame owners, lowest frames used first
+static void reference_map(FILE *out, const int *frames, int total_pages,
+                          int page_size) {
+  fprintf(out, "       Memory Map:\n");
+  int i = 0;
+  while (i < total_pages) {
+    if (frames[i] == -1) {
+      int j = i;
+      while (j < total_pages && frames[j] == -1) j++;
+      fprintf(out, "                  %d-%d: Free frame(s)\n", i * page_size,
+              j * page_size - 1);
+      i = j;
+      continue;
+    }
+    int page = 0;
+    for (int k = 0; k <= i; k++) page += frames[k] == frames[i];
+    fprintf(out, "                  %d-%d: Process %d, Page %d\n",
+            i * page_size, (i + 1) * page_size - 1, frames[i], page);
+    i++;
+  }
+}
+
+static void reference_queue(FILE *out, const int *queue, int head, int tail) {
+  fprintf(out, "       Input Queue:[");
+  for (int i = head; i < tail; i++) {
+    fprintf(out, "%d%s", queue[i], i + 1 < tail ? " " : "");
+  }
+  fprintf(out, "]\n");
+}
+
+/**
+ * Reference model of the simulator's admission and completion rules.
+ *
+ * Args:
+ *   out (FILE*): Stream the event log is written to.
+ *   processes (const Process*): Processes to simulate.
+ *   n (int): Number of processes.
+ *   page_size (int): Page size in KB (memory is TOTAL_MEMORY KB).
+ *   end_time (int): Last tick simulated.
+ *   maps (int): Whether a memory map follows each admission and completion.
+ *   backfill_after (int): Last tick admitted first-come first-served; later
+ * ticks admit with backfill (-1 for first-come first-served throughout).
+ *
+ * Behavior:
+ *   - Deliberately naive: every tick enqueues arrivals in input order,
+ * completes processes in input order, then admits queue heads while the
+ * number of free frames covers the head's rounded-up pieces. Admitted
+ * processes take the lowest free frames.
+ *   - With backfill, every queued process whose pieces are covered is
+ * admitted, in queue order, not just the heads.
+ */
+static void reference_run(FILE *out, const Process *processes, int n,
+                          int page_size, int end_time, int maps,
+                          int backfill_after) {
+  int total_pages = TOTAL_MEMORY / page_size;
+  int *frames = malloc(total_pages * sizeof(int));
+  int *queue = malloc((n > 0 ? n : 1) * sizeof(int));
+  int *queue_index = malloc((n > 0 ? n : 1) * sizeof(int));
+  int *start = malloc((n > 0 ? n : 1) * sizeof(int));
+  if (!frames || !queue || !queue_index || !start) {
+    perror("Error allocating memory for reference model");
+    exit(EXIT_FAILURE);
+  }
+  for (int i = 0; i < total_pages; i++) frames[i] = -1;
+  for (int i = 0; i < n; i++) start[i] = -1;
+
+  int head = 0, tail = 0, completed = 0;
+  double turnaround = 0;
+
+  for (int t = 0; t <= end_time; t++) {
+    int header = 0;
+
+    for (int i = 0; i < n; i++) {
+      if (processes[i].arrival_time != t) continue;
+      if (!header++) fprintf(out, "\nt = %d:\n", t);
+      queue_index[tail] = i;
+      queue[tail++] = processes[i].id;
+      fprintf(out, "       Process %d arrives\n", processes[i].id);
+      reference_queue(out, queue, head, tail);
+    }
+
+    for (int i = 0; i < n; i++) {
+      if (start[i] == -1 || start[i] + processes[i].lifetime != t) continue;
+      if (!header++) fprintf(out, "\nt = %d:\n", t);
+      fprintf(out, "       Process %d completes\n", processes[i].id);
+      for (int f = 0; f < total_pages; f++) {
+        if (frames[f] == processes[i].id) frames[f] = -1;
+      }
+      if (maps) reference_map(out, frames, total_pages, page_size);
+      turnaround += t - processes[i].arrival_time;
+      completed++;
+    }
+
+    int backfill = backfill_after >= 0 && t > backfill_after;
+    for (int q = head; q < tail;) {
+      const Process *next = &processes[queue_index[q]];
+      int need = 0;
+      for (int j = 0; j < next->memory_pieces; j++) {
+        need += (next->piece_sizes[j] + page_size - 1) / page_size;
+      }
+      int free_frames = 0;
+      for (int f = 0; f < total_pages; f++) free_frames += frames[f] == -1;
+      if (free_frames < need) {
+        if (!backfill) break;
+        q++;
+        continue;
+      }
+
+      for (int f = 0; f < total_pages && need > 0; f++) {
+        if (frames[f] == -1) {
+          frames[f] = next->id;
+          need--;
+        }
+      }
+      start[queue_index[q]] = t;
+      for (int k = q; k > head; k--) {
+        queue[k] = queue[k - 1];
+        queue_index[k] = queue_index[k - 1];
+      }
+      head++;
+      q++;
+      if (!header++) fprintf(out, "\nt = %d:\n", t);
+      fprintf(out, "       MM moves Process %d to memory\n", next->id);
+      reference_queue(out, queue, head, tail);
+      if (maps) reference_map(out, frames, total_pages, page_size);
+    }
+  }
+
+  if (completed > 0) {
+    fprintf(out, "\nAverage Turnaround Time: %.2f\n", turnaround / completed);
+  } else {
+    fprintf(out, "No processes completed. Average Turnaround Time: N/A\n");
+  }
+
+  free(frames);
+  free(queue);
+  free(queue_index);
+  free(start);
+}
+
+// Runs the production simulator in-process and returns its event log
+static char *production_run(Process *processes, int n, int page_size,
+                            const Config *config, int end_time) {
+  char *log = NULL;
+  size_t size = 0;
+  FILE *out = open_memstream(&log, &size);
+  if (!out) {
+    perror("Error opening log buffer");
+    exit(EXIT_FAILURE);
+  }
+
+  compute_page_demand(processes, n, page_size);
+  Memory memory;
+  init_memory(&memory, TOTAL_MEMORY, page_size);
+  if (config->extents) use_extent_table(&memory);
+  if (config->compact) use_compact_table(&memory);
+
+  Simulator sim;
+  sim_init(&sim, processes, n, &memory, out);
+  if (!config->maps) sim.output = OUTPUT_EVENTS;
+  if (config->backfill_after >= 0 && config->backfill_after < end_time) {
+    // Finish in a what-if branch, logging to the same stream
+    sim_run(&sim, config->backfill_after);
+    BranchImage image;
+    branch_image_create(&image, &sim);
+    Simulator branch;
+    branch_open(&image, &sim, &branch, out);
+    sim_set_admission(&branch, ADMIT_BACKFILL);
+    sim_run(&branch, end_time);
+    sim_print_summary(&branch);
+    branch_close(&image, &branch);
+    branch_image_destroy(&image);
+  } else {
+    sim_run(&sim, end_time);
+    sim_print_summary(&sim);
+  }
+  sim_free(&sim);
+  free_memory(&memory);
+  fclose(out);
+  return log;
+}
+
+static char *reference_log(const Process *processes, int n, int page_size,
+                           int end_time, const Config *config) {
+  char *log = NULL;
+  size_t size = 0;
+  FILE *out = open_memstream(&log, &size);
+  if (!out) {
+    perror("Error opening log buffer");
+    exit(EXIT_FAILURE);
+  }
+  int backfill_after =
+      config->backfill_after < end_time ? config->backfill_after : -1;
+  reference_run(out, processes, n, page_size, end_time, config->maps,
+                backfill_after);
+  fclose(out);
+  return log;
+}
+
+// Compares two logs line by line. Returns the 1-based number of the first
+// differing line, or 0 if they match.
+static int first_difference(const char *a, const char *b) {
+  int line = 1;
+  while (*a || *b) {
+    const char *end_a = strchr(a, '\n');
+    const char *end_b = strchr(b, '\n');
+    size_t len_a = end_a ? (size_t)(end_a - a) : strlen(a);
+    size_t len_b = end_b ? (size_t)(end_b - b) : strlen(b);
+    if (len_a != len_b || memcmp(a, b, len_a) != 0) return line;
+    a += len_a + (end_a != NULL);
+    b += len_b + (end_b != NULL);
+    line++;
+  }
+  return 0;
+}
+
+// Prints a numbered line of a log, or "<end of output>"
+static void print_line(const char *label, const char *log, int line) {
+  for (int i = 1; i < line && log; i++) {
+    log = strchr(log, '\n');
+    if (log) log++;
+  }
+  if (!log || !*log) {
+    printf("  %s: <end of output>\n", label);
+    return;
+  }
+  const char *end = strchr(log, '\n');
+  printf("  %s: %.*s\n", label, end ? (int)(end - log) : (int)strlen(log),
+         log);
+}
+
+// Last tick at which any event can happen for a workload
+static int horizon(const Process *processes, int n) {
+  long long end = 0;
+  for (int i = 0; i < n; i++) {
+    if (processes[i].arrival_time > end) end = processes[i].arrival_time;
+    end += processes[i].lifetime;
+  }
+  return end < SIM_END_TIME ? (int)end : SIM_END_TIME;
+}
+
+// Returns the first differing line between the reference model and the
+// production simulator for a workload, or 0 if they agree
+static int diverges(Process *processes, int n, int page_size,
+                    const Config *config) {
+  int end_time = horizon(processes, n);
+  char *expected =
+      reference_log(processes, n, page_size, end_time, config);
+  char *actual = production_run(processes, n, page_size, config, end_time);
+  int line = first_difference(expected, actual);
+  free(expected);
+  free(actual);
+  return line;
+}
+
+// Greedily drops processes while the divergence persists. Returns the new
+// process count; the kept processes are moved to the front of the array.
+static int minimize(Process *processes, int n, int page_size,
+                    const Config *config) {
+  int changed = 1;
+  while (changed && n > 1) {
+    changed = 0;
+    for (int i = 0; i < n && n > 1; i++) {
+      Process dropped = processes[i];
+      size_t tail = (n - i - 1) * sizeof(Process);
+      memmove(&processes[i], &processes[i + 1], tail);
+      if (diverges(processes, n - 1, page_size, config)) {
+        // Park the dropped process behind the kept ones so it is still freed
+        processes[--n] = dropped;
+        changed = 1;
+        i--;
+      } else {
+        memmove(&processes[i + 1], &processes[i], tail);
+        processes[i] = dropped;
+      }
+    }
+  }
+  return n;
+}
+
+// Checks the production simulator against a recorded sample output
+static int check_golden(const char *input, int page_size, const char *golden) {
+  int n;
+  Process *processes = parse_input_file(input, &n);
+  char *actual = production_run(processes, n, page_size, &kConfigs[0],
+                                SIM_END_TIME);
+  free_parsed_data(processes, n);
+
+  FILE *file = fopen(golden, "r");
+  if (!file) {
+    perror("Error opening golden output");
+    free(actual);
+    return 0;
+  }
+  char *expected = NULL;
+  size_t capacity = 0;
+  ssize_t length = getdelim(&expected, &capacity, '\0', file);
+  fclose(file);
+  if (length < 0) length = 0;
+
+  // The samples omit the blank line the simulator prints before t = 0
+  const char *produced = actual[0] == '\n' ? actual + 1 : actual;
+  int line = first_difference(expected ? expected : "", produced);
+  if (line) {
+    printf("FAIL %s (page size %d) differs from %s at line %d\n", input,
+           page_size, golden, line);
+    print_line("expected", expected, line);
+    print_line("actual  ", produced, line);
+  } else {
+    printf("ok   %s (page size %d) matches %s\n", input, page_size, golden);
+  }
+  free(expected);
+  free(actual);
+  return line == 0;
+}
+
+/**
+ * Differential test driver for the simulator.
+ *
+ * Behavior:
+ *   1. Checks `in1.txt` against the sample outputs `out2.txt` and `out3.txt`.
+ *   2. Runs randomized workloads through a naive reference model and through
+ * the production simulator for every configuration in `kConfigs`, comparing
+ * their logs line by line.
+ *   3. On the first divergence, drops processes while it persists and writes
+ * the smallest failing workload to `verify_repro.txt`.
+ *
+ * Returns:
+ *   EXIT_SUCCESS if everything matched, EXIT_FAILURE otherwise.
+ */
+int main(int argc, char *argv[]) {
+  int trials = 200;
+  unsigned long long seed = 1;
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], "--trials=", 9) == 0) {
+      trials = atoi(argv[i] + 9);
+    } else if (strncmp(argv[i], "--seed=", 7) == 0) {
+      seed = strtoull(argv[i] + 7, NULL, 10);
+    } else {
+      fprintf(stderr, "Usage: %s [--trials=N] [--seed=S]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  int ok = check_golden("in1.txt", 200, "out2.txt");
+  ok &= check_golden("in1.txt", 400, "out3.txt");
+
+  for (int trial = 0; trial < trials && ok; trial++) {
+    WorkloadSpec spec;
+    default_workload_spec(&spec);
+    spec.seed = seed + trial;
+    spec.num_processes = 1 + (int)(spec.seed * 7919 % 30);
+    spec.arrival = (Distribution){DIST_EXPONENTIAL, 1 + trial % 200, 0};
+    spec.lifetime = (Distribution){DIST_UNIFORM, 1, 100 + trial * 13 % 2000};
+    spec.pieces = (Distribution){DIST_UNIFORM, 1, 1 + trial % 4};
+    spec.piece_size = (Distribution){DIST_UNIFORM, 1, 100 + trial * 31 % 900};
+    int page_size = kPageSizes[trial % NUM_PAGE_SIZES];
+
+    int n;
+    Process *processes = generate_workload(&spec, &n);
+    for (int c = 0; c < NUM_CONFIGS && ok; c++) {
+      int line = diverges(processes, n, page_size, &kConfigs[c]);
+      if (!line) continue;
+
+      ok = 0;
+      int kept = minimize(processes, n, page_size, &kConfigs[c]);
+      int end_time = horizon(processes, kept);
+      char *expected =
+          reference_log(processes, kept, page_size, end_time, &kConfigs[c]);
+      char *actual = production_run(processes, kept, page_size,
+                                    &kConfigs[c], end_time);
+      line = first_difference(expected, actual);
+      printf("FAIL trial %d (%s, page size %d): %d-process reproducer "
+             "diverges at line %d\n",
+             trial, kConfigs[c].name, page_size, kept, line);
+      print_line("reference ", expected, line);
+      print_line("production", actual, line);
+      free(expected);
+      free(actual);
+
+      FILE *repro = fopen("verify_repro.txt", "w");
+      if (repro) {
+        write_workload(repro, processes, kept);
+        fclose(repro);
+        printf("  reproducer written to verify_repro.txt; run "
+               "./memory_simulator verify_repro.txt %d %d%s\n",
+               TOTAL_MEMORY, page_size, kConfigs[c].flags);
+      }
+    }
+    free_parsed_data(processes, n);
+    if (ok && (trial + 1) % 50 == 0) {
+      printf("ok   %d randomized workloads agree with the reference model\n",
+             trial + 1);
+    }
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
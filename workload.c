@@ -0,0 +1,177 @@
+#include "workload.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// xorshift64* generator, so workloads are reproducible across platforms
+static unsigned long long next_random(unsigned long long *state) {
+  *state ^= *state >> 12;
+  *state ^= *state << 25;
+  *state ^= *state >> 27;
+  return *state * 2685821657736338717ULL;
+}
+
+// Uniform double in (0, 1)
+static double next_unit(unsigned long long *state) {
+  return ((next_random(state) >> 11) + 0.5) / 9007199254740992.0;
+}
+
+// Draws one value from a distribution
+static int draw(const Distribution *dist, unsigned long long *state) {
+  switch (dist->kind) {
+    case DIST_UNIFORM: {
+      int low = (int)dist->a, high = (int)dist->b;
+      if (high <= low) return low;
+      return low + (int)(next_random(state) % (unsigned)(high - low + 1));
+    }
+    case DIST_EXPONENTIAL: {
+      int value = (int)lround(-dist->a * log(next_unit(state)));
+      return value < (int)dist->b ? (int)dist->b : value;
+    }
+    default:
+      return (int)dist->a;
+  }
+}
+
+/**
+ * Fills in a workload shaped roughly like `in1.txt`.
+ *
+ * Args:
+ *   spec (WorkloadSpec*): Specification to fill in.
+ *
+ * Behavior:
+ *   - 1000 processes with Poisson arrivals every 50 ticks on average,
+ * lifetimes uniform in [100, 2000], one to three pieces of 50-400 KB each.
+ */
+void default_workload_spec(WorkloadSpec *spec) {
+  spec->num_processes = 1000;
+  spec->arrival = (Distribution){DIST_EXPONENTIAL, 50, 0};
+  spec->lifetime = (Distribution){DIST_UNIFORM, 100, 2000};
+  spec->pieces = (Distribution){DIST_UNIFORM, 1, 3};
+  spec->piece_size = (Distribution){DIST_UNIFORM, 50, 400};
+  spec->seed = 1;
+}
+
+/**
+ * Parses a distribution from its command-line form.
+ *
+ * Args:
+ *   text (const char*): One of "N" (constant), "uniform:MIN:MAX",
+ * "exp:MEAN[:MIN]", "poisson:MEAN_GAP" or "bursty:SIZE:GAP".
+ *   dist (Distribution*): Receives the parsed distribution.
+ *
+ * Returns:
+ *   int: 1 if `text` is well formed, 0 otherwise.
+ *
+ * Notes:
+ *   - "poisson" is the exponential distribution of gaps between Poisson
+ * arrivals, with a minimum gap of 0.
+ */
+int parse_distribution(const char *text, Distribution *dist) {
+  double a = 0, b = 0;
+  char extra;
+
+  if (strncmp(text, "uniform:", 8) == 0) {
+    if (sscanf(text + 8, "%lf:%lf%c", &a, &b, &extra) != 2 || b < a) return 0;
+    *dist = (Distribution){DIST_UNIFORM, a, b};
+  } else if (strncmp(text, "exp:", 4) == 0) {
+    int n = sscanf(text + 4, "%lf:%lf%c", &a, &b, &extra);
+    if (n != 1 && n != 2) return 0;
+    *dist = (Distribution){DIST_EXPONENTIAL, a, n == 2 ? b : 1};
+  } else if (strncmp(text, "poisson:", 8) == 0) {
+    if (sscanf(text + 8, "%lf%c", &a, &extra) != 1) return 0;
+    *dist = (Distribution){DIST_EXPONENTIAL, a, 0};
+  } else if (strncmp(text, "bursty:", 7) == 0) {
+    if (sscanf(text + 7, "%lf:%lf%c", &a, &b, &extra) != 2 || a < 1) return 0;
+    *dist = (Distribution){DIST_BURSTY, a, b};
+  } else {
+    if (sscanf(text, "%lf%c", &a, &extra) != 1) return 0;
+    *dist = (Distribution){DIST_CONSTANT, a, 0};
+  }
+  return a >= 0 && b >= 0;
+}
+
+/**
+ * Generates a synthetic workload.
+ *
+ * Args:
+ *   spec (WorkloadSpec*): Workload parameters.
+ *   num_processes (int*): Receives the number of generated processes.
+ *
+ * Returns:
+ *   Process*: Array of processes with IDs 1..n in arrival order, laid out like
+ * the output of `parse_input_file` and released with `free_parsed_data`.
+ *
+ * Errors:
+ *   - Exits the program with an error message if memory allocation fails.
+ */
+Process *generate_workload(const WorkloadSpec *spec, int *num_processes) {
+  unsigned long long state = spec->seed ? spec->seed : 1;
+  int n = spec->num_processes;
+  Process *processes = malloc((n > 0 ? n : 1) * sizeof(Process));
+  if (!processes) {
+    perror("Error allocating memory for processes");
+    exit(EXIT_FAILURE);
+  }
+
+  int clock = 0;
+  for (int i = 0; i < n; i++) {
+    Process *process = &processes[i];
+
+    if (i > 0) {
+      if (spec->arrival.kind == DIST_BURSTY) {
+        if (i % (int)spec->arrival.a == 0) clock += (int)spec->arrival.b;
+      } else {
+        clock += draw(&spec->arrival, &state);
+      }
+    }
+
+    process->id = i + 1;
+    process->arrival_time = clock;
+    process->lifetime = draw(&spec->lifetime, &state);
+    if (process->lifetime < 1) process->lifetime = 1;
+    process->memory_pieces = draw(&spec->pieces, &state);
+    if (process->memory_pieces < 1) process->memory_pieces = 1;
+
+    process->piece_sizes = malloc(process->memory_pieces * sizeof(int));
+    if (!process->piece_sizes) {
+      perror("Error allocating memory for piece sizes");
+      exit(EXIT_FAILURE);
+    }
+    for (int j = 0; j < process->memory_pieces; j++) {
+      process->piece_sizes[j] = draw(&spec->piece_size, &state);
+      if (process->piece_sizes[j] < 1) process->piece_sizes[j] = 1;
+    }
+
+    process->start_time = -1;
+    process->piece_pages = NULL;
+    process->pages_needed = 0;
+    process->demand_page_size = 0;
+  }
+
+  *num_processes = n;
+  return processes;
+}
+
+/**
+ * Writes processes in the input file format read by `parse_input_file`.
+ *
+ * Args:
+ *   out (FILE*): Stream to write to.
+ *   processes (const Process*): Processes to write.
+ *   num_processes (int): Number of processes.
+ */
+void write_workload(FILE *out, const Process *processes, int num_processes) {
+  fprintf(out, "%d\n", num_processes);
+  for (int i = 0; i < num_processes; i++) {
+    const Process *process = &processes[i];
+    fprintf(out, "%d\n%d %d\n%d", process->id, process->arrival_time,
+            process->lifetime, process->memory_pieces);
+    for (int j = 0; j < process->memory_pieces; j++) {
+      fprintf(out, " %d", process->piece_sizes[j]);
+    }
+    fprintf(out, "\n\n");
+  }
+}
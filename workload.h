@@ -0,0 +1,39 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdio.h>
+
+#include "parser.h"
+
+// Shape of a random variable drawn by the workload generator
+typedef enum {
+  DIST_CONSTANT,     // Always `a`
+  DIST_UNIFORM,      // Uniform integer in [a, b]
+  DIST_EXPONENTIAL,  // Exponential with mean `a`, rounded, at least `b`
+  DIST_BURSTY,       // Arrival gaps only: `a` processes per burst, bursts `b`
+                     // ticks apart
+} DistKind;
+
+typedef struct {
+  DistKind kind;
+  double a;
+  double b;
+} Distribution;
+
+// Parameters of a synthetic workload
+typedef struct {
+  int num_processes;        // Number of processes to generate
+  Distribution arrival;     // Gap between consecutive arrivals (ticks)
+  Distribution lifetime;    // Lifetime of each process (ticks)
+  Distribution pieces;      // Number of memory pieces per process
+  Distribution piece_size;  // Size of each memory piece (KB)
+  unsigned long long seed;  // Seed of the random generator
+} WorkloadSpec;
+
+// Function prototypes
+void default_workload_spec(WorkloadSpec *spec);
+int parse_distribution(const char *text, Distribution *dist);
+Process *generate_workload(const WorkloadSpec *spec, int *num_processes);
+void write_workload(FILE *out, const Process *processes, int num_processes);
+
+#endif